@@ -8,6 +8,9 @@
 /* SDL */
 #include "../sdl/sdl.h"
 
+/* Media */
+#include "../media/decoder.h"
+
 
 // Global preview box - add to layer struct ? 
 GtkWidget *layer_preview_boxes[MAX_LAYERS] = { NULL };
@@ -134,8 +137,11 @@ void set_preview_thumbnail(guint8 layer_index)
         add_main_log(g_strdup_printf("[INFO] Layer %u preview set to EMPTY", layer_index + 1));
     } else {
         // HAS FRAMES: apply unique CSS background
+        // Ingest writes a single preview image; older folders only have frames
         char frame_path[512];
-        snprintf(frame_path, sizeof(frame_path), "%s/frame_00001.png", folder);
+        snprintf(frame_path, sizeof(frame_path), "%s/%s", folder, DECODER_PREVIEW_NAME);
+        if (!g_file_test(frame_path, G_FILE_TEST_IS_REGULAR))
+            snprintf(frame_path, sizeof(frame_path), "%s/frame_00001.png", folder);
 
         gchar *abs_path = g_path_is_absolute(frame_path)
             ? g_strdup(frame_path)
@@ -22,7 +22,7 @@ static void on_live_mode_clicked(GtkButton *button, gpointer user_data)
 {
     (void)button;
     (void)user_data;
-    g_sdl.screen_mode = LIVE_MODE;
+    sdl_set_screen_mode(LIVE_MODE);
     update_mode_buttons_active_state();
 
 }
@@ -32,7 +32,7 @@ static void on_playback_mode_clicked(GtkButton *button, gpointer user_data)
 {
     (void)button;
     (void)user_data;
-    g_sdl.screen_mode = PLAYBACK_MODE;
+    sdl_set_screen_mode(PLAYBACK_MODE);
     update_mode_buttons_active_state();
 }
 
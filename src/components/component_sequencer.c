@@ -2,6 +2,7 @@
 #include "component_sequencer.h"
 #include "../modals/modal_download.h"
 #include "../utils/accessor.h"
+#include "../media/decoder.h"
 
 // Globals - TO REFACT
 int left_bar_x  = -1;
@@ -168,7 +169,12 @@ GtkWidget* create_sequence_widget_css(const char *sequence_folder) {
     gtk_widget_set_vexpand(event_box, TRUE);
     gtk_widget_set_name(event_box, "sequence-preview-css");
 
-    gchar *frame_path = g_build_filename(sequence_folder, "mixed_frames/frame_00001.png", NULL);
+    // Bake writes a preview image next to the pack; older sequences only have PNG frames
+    gchar *frame_path = g_build_filename(sequence_folder, DECODER_PREVIEW_NAME, NULL);
+    if (!g_file_test(frame_path, G_FILE_TEST_IS_REGULAR)) {
+        g_free(frame_path);
+        frame_path = g_build_filename(sequence_folder, "mixed_frames/frame_00001.png", NULL);
+    }
 
     if (g_file_test(frame_path, G_FILE_TEST_IS_REGULAR)) {
         GtkCssProvider *provider = gtk_css_provider_new();
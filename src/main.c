@@ -4,10 +4,12 @@
 #include <time.h>
 #include <stdio.h>
 #include <locale.h>
+#include <signal.h>
 #include <X11/Xlib.h>
 
 /* SDL engine */
 #include "sdl/sdl.h"
+#include "sdl/render_thread.h"
 #include "utils/accessor.h"
 
 /* Components */
@@ -18,6 +20,7 @@
 
 /* Utilities */
 #include "utils/utils.h"
+#include "media/pixel_fx.h"
 
 /* Modals */
 #include "modals/modal_add_sequence.h"
@@ -30,7 +33,19 @@ static gboolean on_key_press(GtkWidget *widget, GdkEventKey *event, gpointer use
 int main(int argc, char *argv[]) {
 	
 	srand((unsigned)time(NULL));
+
+    // Pixel kernel throughput report, no UI (PULSRR_FX_BENCH=1 ./pulsrr)
+    if (g_getenv("PULSRR_FX_BENCH")) {
+        pixel_fx_benchmark();
+        return EXIT_SUCCESS;
+    }
+
+    // GTK and the render thread both talk to the X server
+    XInitThreads();
     gtk_init(&argc, &argv);
+
+    // A dead FFmpeg pipe is a write error, not a crash
+    signal(SIGPIPE, SIG_IGN);
  	init_app_paths(argv[0]);
     AppContext ctx = {0};
     const AppPaths *paths = get_app_paths();
@@ -196,20 +211,22 @@ static void on_update_render_clicked(GtkButton *button, gpointer user_data)
     (void)button;
     (void)user_data;
 
-    gboolean has_modified = FALSE;
+    int modified = 0;
     for (guint8 i = 0; i < MAX_LAYERS; i++) {
-        if (sdl_get_layer_state(i) == LAYER_MODIFIED) {
-            has_modified = TRUE;
-            break;
-        }
+        if (sdl_get_layer_state(i) == LAYER_MODIFIED)
+            modified++;
     }
 
-    if (!has_modified) {
+    if (!modified) {
     	add_main_log("[UPDATE] No layers need updating. Skipping texture update.");
         return;
     }
 
-    sdl_set_render_state(RENDER_STATE_LOADING);
+    gchar *msg = g_strdup_printf("[UPDATE] Reloading %d modified layer(s)", modified);
+    add_main_log(msg);
+    g_free(msg);
+
+    // Layers become playable progressively; the others never stop
     update_textures_async();
 }
 
@@ -217,6 +234,8 @@ static void on_app_destroy(GtkWidget *widget, gpointer data)
 {
     (void)widget;
     (void)data;
+    // Stop drawing before GTK tears the output window down
+    render_thread_stop();
     cleanup_frames_folders();
     gtk_main_quit();
 }
@@ -0,0 +1,517 @@
+/* In-process video decoder (libavformat / libavcodec / libswscale) */
+#include "decoder.h"
+#include "../utils/utils.h"
+
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+#include <libavutil/imgutils.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+struct Decoder {
+    AVFormatContext   *fmt;
+    AVCodecContext    *codec;
+    struct SwsContext *sws;
+    AVPacket *pkt;
+    AVFrame  *cur;          // frame shown for the next output index
+    AVFrame  *next;         // look-ahead frame
+    int       have_cur;
+    int       have_next;
+    int64_t   cur_index;
+    int64_t   next_index;
+    int64_t   decoded;      // source frames decoded so far
+    int64_t   next_out;     // index of the next output frame
+    int64_t   end_index;    // first output index past the end of the clip
+    int       stream_index;
+    AVRational time_base;
+    int64_t   start_pts;
+    int       fps;
+    int       out_width;
+    int       out_height;
+    double    duration;
+    double    position;
+    int       flushing;
+    int       eof;
+};
+
+// SDL_PIXELFORMAT_ARGB8888 is stored B,G,R,A in memory on little-endian hosts
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+#define DECODER_AV_PIX_FMT AV_PIX_FMT_ARGB
+#else
+#define DECODER_AV_PIX_FMT AV_PIX_FMT_BGRA
+#endif
+
+// Open / close
+Decoder* decoder_open(const char *path, int fps, int width)
+{
+    if (!path || !*path) return NULL;
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    Decoder *dec = g_new0(Decoder, 1);
+    dec->stream_index = -1;
+    dec->fps = fps > 0 ? fps : 0;
+
+    if (avformat_open_input(&dec->fmt, path, NULL, NULL) < 0) {
+        g_printerr("[DECODER] Cannot open %s\n", path);
+        goto fail;
+    }
+
+    if (avformat_find_stream_info(dec->fmt, NULL) < 0) {
+        g_printerr("[DECODER] No stream info in %s\n", path);
+        goto fail;
+    }
+
+    const AVCodec *codec = NULL;
+    dec->stream_index = av_find_best_stream(dec->fmt, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    if (dec->stream_index < 0 || !codec) {
+        g_printerr("[DECODER] No video stream in %s\n", path);
+        goto fail;
+    }
+
+    AVStream *st = dec->fmt->streams[dec->stream_index];
+    dec->codec = avcodec_alloc_context3(codec);
+    if (!dec->codec || avcodec_parameters_to_context(dec->codec, st->codecpar) < 0) {
+        g_printerr("[DECODER] Cannot set up codec for %s\n", path);
+        goto fail;
+    }
+
+    dec->codec->thread_count = 0; // let libavcodec pick
+    if (avcodec_open2(dec->codec, codec, NULL) < 0) {
+        g_printerr("[DECODER] Cannot open codec %s\n", codec->name);
+        goto fail;
+    }
+
+    dec->time_base = st->time_base;
+    dec->start_pts = st->start_time != AV_NOPTS_VALUE ? st->start_time : 0;
+
+    if (st->duration > 0)
+        dec->duration = st->duration * av_q2d(st->time_base);
+    else if (dec->fmt->duration > 0)
+        dec->duration = (double)dec->fmt->duration / AV_TIME_BASE;
+
+    // Output size: fixed width, height keeps the aspect ratio (like scale=W:-1)
+    int src_w = dec->codec->width;
+    int src_h = dec->codec->height;
+    if (src_w <= 0 || src_h <= 0) {
+        g_printerr("[DECODER] Invalid frame size in %s\n", path);
+        goto fail;
+    }
+
+    dec->out_width = width > 0 ? width : src_w;
+    dec->out_height = (int)lrint((double)dec->out_width * src_h / src_w);
+    if (dec->out_height < 1) dec->out_height = 1;
+
+    dec->end_index = dec->fps > 0 ? (int64_t)llrint(dec->duration * dec->fps) : 0;
+
+    dec->pkt = av_packet_alloc();
+    dec->cur = av_frame_alloc();
+    dec->next = av_frame_alloc();
+    if (!dec->pkt || !dec->cur || !dec->next) goto fail;
+
+    return dec;
+
+fail:
+    decoder_close(dec);
+    return NULL;
+}
+
+void decoder_close(Decoder *dec)
+{
+    if (!dec) return;
+
+    if (dec->sws) sws_freeContext(dec->sws);
+    av_frame_free(&dec->cur);
+    av_frame_free(&dec->next);
+    av_packet_free(&dec->pkt);
+    avcodec_free_context(&dec->codec);
+    if (dec->fmt) avformat_close_input(&dec->fmt);
+    g_free(dec);
+}
+
+// Pull the next decoded source frame into dst (1 = frame, 0 = end, -1 = error)
+static int decode_next(Decoder *dec, AVFrame *dst)
+{
+    av_frame_unref(dst);
+
+    for (;;) {
+        int ret = avcodec_receive_frame(dec->codec, dst);
+        if (ret == 0) {
+            dec->decoded++;
+            return 1;
+        }
+        if (ret == AVERROR_EOF) return 0;
+        if (ret != AVERROR(EAGAIN)) return -1;
+        if (dec->flushing) return 0;
+
+        ret = av_read_frame(dec->fmt, dec->pkt);
+        if (ret < 0) {
+            // End of file: drain the decoder
+            avcodec_send_packet(dec->codec, NULL);
+            dec->flushing = 1;
+            continue;
+        }
+
+        if (dec->pkt->stream_index == dec->stream_index)
+            avcodec_send_packet(dec->codec, dec->pkt);
+        av_packet_unref(dec->pkt);
+    }
+}
+
+// Presentation time of a frame in seconds from the stream start
+static double frame_time(Decoder *dec, const AVFrame *frame)
+{
+    int64_t pts = frame->best_effort_timestamp;
+    if (pts == AV_NOPTS_VALUE) pts = frame->pts;
+    if (pts == AV_NOPTS_VALUE) {
+        AVRational rate = av_guess_frame_rate(dec->fmt, dec->fmt->streams[dec->stream_index], NULL);
+        double fps = rate.num > 0 && rate.den > 0 ? av_q2d(rate) : 25.0;
+        return (dec->decoded - 1) / fps;
+    }
+    return (pts - dec->start_pts) * av_q2d(dec->time_base);
+}
+
+// Convert a decoded frame to a fresh ARGB8888 surface
+static SDL_Surface* convert_frame(Decoder *dec, const AVFrame *frame)
+{
+    dec->sws = sws_getCachedContext(dec->sws,
+                                    frame->width, frame->height, frame->format,
+                                    dec->out_width, dec->out_height, DECODER_AV_PIX_FMT,
+                                    SWS_BILINEAR, NULL, NULL, NULL);
+    if (!dec->sws) {
+        g_printerr("[DECODER] sws_getCachedContext failed\n");
+        return NULL;
+    }
+
+    SDL_Surface *surf = SDL_CreateRGBSurfaceWithFormat(0, dec->out_width, dec->out_height,
+                                                       32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surf) {
+        g_printerr("[DECODER] Surface allocation failed: %s\n", SDL_GetError());
+        return NULL;
+    }
+
+    uint8_t *dst_data[4] = { surf->pixels, NULL, NULL, NULL };
+    int dst_linesize[4] = { surf->pitch, 0, 0, 0 };
+    sws_scale(dec->sws, (const uint8_t * const *)frame->data, frame->linesize,
+              0, frame->height, dst_data, dst_linesize);
+
+    return surf;
+}
+
+// Scale a decoded frame into a fresh planar YUV420 frame (no colour conversion)
+static YuvFrame* convert_frame_yuv(Decoder *dec, const AVFrame *frame)
+{
+    dec->sws = sws_getCachedContext(dec->sws,
+                                    frame->width, frame->height, frame->format,
+                                    dec->out_width, dec->out_height, AV_PIX_FMT_YUV420P,
+                                    SWS_BILINEAR, NULL, NULL, NULL);
+    if (!dec->sws) {
+        g_printerr("[DECODER] sws_getCachedContext failed\n");
+        return NULL;
+    }
+
+    YuvFrame *yuv = yuv_frame_new(dec->out_width, dec->out_height);
+    if (!yuv) {
+        g_printerr("[DECODER] YUV frame allocation failed\n");
+        return NULL;
+    }
+
+    uint8_t *dst_data[4] = { yuv->planes[0], yuv->planes[1], yuv->planes[2], NULL };
+    int dst_linesize[4] = { yuv->pitches[0], yuv->pitches[1], yuv->pitches[2], 0 };
+    sws_scale(dec->sws, (const uint8_t * const *)frame->data, frame->linesize,
+              0, frame->height, dst_data, dst_linesize);
+
+    return yuv;
+}
+
+// Step to the next output frame, leaving it in dec->cur (1 = frame, 0 = end, -1 = error)
+static int advance(Decoder *dec)
+{
+    // Native rate: every decoded frame is an output frame
+    if (dec->fps <= 0) {
+        int ret = decode_next(dec, dec->cur);
+        if (ret <= 0) return ret;
+        dec->position = frame_time(dec, dec->cur);
+        dec->next_out++;
+        return 1;
+    }
+
+    // Resample to the requested rate (nearest frame, like ffmpeg's fps filter)
+    for (;;) {
+        if (!dec->have_next && !dec->eof) {
+            int ret = decode_next(dec, dec->next);
+            if (ret < 0) return -1;
+            if (ret == 0) {
+                dec->eof = 1;
+            } else {
+                dec->next_index = (int64_t)llrint(frame_time(dec, dec->next) * dec->fps);
+                dec->have_next = 1;
+            }
+        }
+
+        if (dec->have_next && (!dec->have_cur || dec->next_index <= dec->next_out)) {
+            AVFrame *tmp = dec->cur;
+            dec->cur = dec->next;
+            dec->next = tmp;
+            dec->cur_index = dec->next_index;
+            dec->have_cur = 1;
+            dec->have_next = 0;
+            continue;
+        }
+        break;
+    }
+
+    if (!dec->have_cur) return 0;
+
+    // Past the last frame: repeat it only up to the clip duration
+    if (dec->eof && dec->next_out > dec->cur_index && dec->next_out >= dec->end_index)
+        return 0;
+
+    dec->position = (double)dec->next_out / dec->fps;
+    dec->next_out++;
+    return 1;
+}
+
+int decoder_read_frame(Decoder *dec, SDL_Surface **out)
+{
+    if (!dec || !out) return -1;
+    *out = NULL;
+
+    int ret = advance(dec);
+    if (ret <= 0) return ret;
+
+    *out = convert_frame(dec, dec->cur);
+    return *out ? 1 : -1;
+}
+
+int decoder_read_frame_yuv(Decoder *dec, YuvFrame **out)
+{
+    if (!dec || !out) return -1;
+    *out = NULL;
+
+    int ret = advance(dec);
+    if (ret <= 0) return ret;
+
+    *out = convert_frame_yuv(dec, dec->cur);
+    return *out ? 1 : -1;
+}
+
+int decoder_skip_frame(Decoder *dec)
+{
+    if (!dec) return -1;
+    return advance(dec);
+}
+
+int decoder_tell(const Decoder *dec)
+{
+    return dec ? (int)dec->next_out : 0;
+}
+
+int decoder_seek_frame(Decoder *dec, int index)
+{
+    if (!dec) return -1;
+    if (index < 0) index = 0;
+    if (dec->fps <= 0) index = 0;
+
+    double seconds = dec->fps > 0 ? (double)index / dec->fps : 0.0;
+    int64_t ts = dec->start_pts + (int64_t)(seconds / av_q2d(dec->time_base));
+
+    if (av_seek_frame(dec->fmt, dec->stream_index, ts, AVSEEK_FLAG_BACKWARD) < 0) {
+        g_printerr("[DECODER] Seek to frame %d failed\n", index);
+        return -1;
+    }
+    avcodec_flush_buffers(dec->codec);
+
+    av_frame_unref(dec->cur);
+    av_frame_unref(dec->next);
+    dec->have_cur = 0;
+    dec->have_next = 0;
+    dec->flushing = 0;
+    dec->eof = 0;
+    dec->next_out = index;
+    dec->position = seconds;
+    return 0;
+}
+
+// Info
+double decoder_get_duration(const Decoder *dec)
+{
+    return dec ? dec->duration : 0.0;
+}
+
+double decoder_get_progress(const Decoder *dec)
+{
+    if (!dec || dec->duration <= 0.0) return 0.0;
+    double fraction = dec->position / dec->duration;
+    return fraction > 1.0 ? 1.0 : fraction;
+}
+
+int decoder_estimate_frame_count(const Decoder *dec)
+{
+    if (!dec) return 0;
+    if (dec->fps > 0) return (int)dec->end_index;
+
+    AVStream *st = dec->fmt->streams[dec->stream_index];
+    if (st->nb_frames > 0) return (int)st->nb_frames;
+
+    AVRational rate = av_guess_frame_rate(dec->fmt, st, NULL);
+    if (rate.num <= 0 || rate.den <= 0) return 0;
+    return (int)llrint(dec->duration * av_q2d(rate));
+}
+
+void decoder_get_output_size(const Decoder *dec, int *width, int *height)
+{
+    if (width)  *width  = dec ? dec->out_width : 0;
+    if (height) *height = dec ? dec->out_height : 0;
+}
+
+// Manifest helpers
+int decoder_write_manifest(const char *folder, const DecoderManifest *manifest)
+{
+    if (!folder || !manifest || !manifest->source) return -1;
+
+    gchar *path = g_build_filename(folder, DECODER_MANIFEST_NAME, NULL);
+    FILE *f = fopen(path, "w");
+    g_free(path);
+    if (!f) return -1;
+
+    fprintf(f, "source=%s\n", manifest->source);
+    fprintf(f, "fps=%d\n", manifest->fps);
+    fprintf(f, "width=%d\n", manifest->width);
+    fprintf(f, "frames=%d\n", manifest->frame_count);
+    fclose(f);
+    return 0;
+}
+
+int decoder_read_manifest(const char *folder, DecoderManifest *manifest)
+{
+    if (!folder || !manifest) return -1;
+    memset(manifest, 0, sizeof(*manifest));
+
+    gchar *path = g_build_filename(folder, DECODER_MANIFEST_NAME, NULL);
+    FILE *f = fopen(path, "r");
+    g_free(path);
+    if (!f) return -1;
+
+    char line[PATH_MAX + 16];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = 0;
+        if (strncmp(line, "source=", 7) == 0) {
+            g_free(manifest->source);
+            manifest->source = g_strdup(line + 7);
+        } else if (strncmp(line, "fps=", 4) == 0) {
+            manifest->fps = atoi(line + 4);
+        } else if (strncmp(line, "width=", 6) == 0) {
+            manifest->width = atoi(line + 6);
+        } else if (strncmp(line, "frames=", 7) == 0) {
+            manifest->frame_count = atoi(line + 7);
+        }
+    }
+    fclose(f);
+
+    return manifest->source ? 0 : -1;
+}
+
+void decoder_free_manifest(DecoderManifest *manifest)
+{
+    if (!manifest) return;
+    g_free(manifest->source);
+    manifest->source = NULL;
+}
+
+// Legacy ingest folders: frame_00001.png ... frame_NNNNN.png
+int decoder_queue_png_frames(FrameLoader *loader, const char *folder, SDL_Surface ***frames)
+{
+    int count = count_frames(folder);
+    if (count <= 0) return 0;
+
+    *frames = g_malloc0(sizeof(SDL_Surface*) * count);
+
+    for (int f = 0; f < count; f++) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/frame_%05d.png", folder, f + 1);
+        frame_loader_add_file(loader, path, &(*frames)[f]);
+    }
+
+    return count;
+}
+
+static SDL_Surface** load_png_frames(const char *folder, int *out_count)
+{
+    SDL_Surface **frames = NULL;
+    FrameLoader *loader = frame_loader_new();
+    int count = decoder_queue_png_frames(loader, folder, &frames);
+    frame_loader_free(loader);
+
+    *out_count = count;
+    return frames;
+}
+
+// Decoder on the source of a manifest folder (the manifest is freed)
+static Decoder* open_manifest_source(const char *folder, DecoderManifest *manifest)
+{
+    Decoder *dec = decoder_open(manifest->source, manifest->fps, manifest->width);
+    if (!dec)
+        g_printerr("[DECODER] Source unavailable for %s: %s\n", folder, manifest->source);
+    decoder_free_manifest(manifest);
+    return dec;
+}
+
+SDL_Surface** decoder_load_folder(const char *folder, int *out_count)
+{
+    if (!out_count) return NULL;
+    *out_count = 0;
+    if (!folder) return NULL;
+
+    DecoderManifest manifest;
+    if (decoder_read_manifest(folder, &manifest) != 0)
+        return load_png_frames(folder, out_count);
+
+    int expected = manifest.frame_count;
+    Decoder *dec = open_manifest_source(folder, &manifest);
+    if (!dec) return NULL;
+
+    GPtrArray *frames = g_ptr_array_sized_new(MAX(expected, 1));
+    SDL_Surface *surf = NULL;
+    while (decoder_read_frame(dec, &surf) > 0)
+        g_ptr_array_add(frames, surf);
+
+    decoder_close(dec);
+
+    *out_count = frames->len;
+    if (frames->len == 0) {
+        g_ptr_array_free(frames, TRUE);
+        return NULL;
+    }
+    return (SDL_Surface **)g_ptr_array_free(frames, FALSE);
+}
+
+YuvFrame** decoder_load_folder_yuv(const char *folder, int *out_count)
+{
+    if (!out_count) return NULL;
+    *out_count = 0;
+    if (!folder) return NULL;
+
+    DecoderManifest manifest;
+    if (decoder_read_manifest(folder, &manifest) != 0) return NULL;
+
+    int expected = manifest.frame_count;
+    Decoder *dec = open_manifest_source(folder, &manifest);
+    if (!dec) return NULL;
+
+    GPtrArray *frames = g_ptr_array_sized_new(MAX(expected, 1));
+    YuvFrame *yuv = NULL;
+    while (decoder_read_frame_yuv(dec, &yuv) > 0)
+        g_ptr_array_add(frames, yuv);
+
+    decoder_close(dec);
+
+    *out_count = frames->len;
+    if (frames->len == 0) {
+        g_ptr_array_free(frames, TRUE);
+        return NULL;
+    }
+    return (YuvFrame **)g_ptr_array_free(frames, FALSE);
+}
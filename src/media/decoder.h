@@ -0,0 +1,61 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+#include "frame_loader.h"
+#include "yuv_frame.h"
+
+// Ingest manifest written next to a layer's frames (Frames_N/source.txt)
+#define DECODER_MANIFEST_NAME "source.txt"
+#define DECODER_PREVIEW_NAME  "preview.png"
+
+typedef struct Decoder Decoder;
+
+typedef struct {
+    char *source;       // path of the video file
+    int   fps;          // output frame rate (0 = native)
+    int   width;        // output width (0 = native)
+    int   frame_count;  // frames produced at ingest
+} DecoderManifest;
+
+// Open / close
+Decoder* decoder_open(const char *path, int fps, int width);
+void decoder_close(Decoder *dec);
+
+// Decode the next output frame as an ARGB8888 surface.
+// Returns 1 when a frame was produced, 0 at end of stream, -1 on error.
+int decoder_read_frame(Decoder *dec, SDL_Surface **out);
+
+// Same, keeping the frame as planar YUV420 (scaled, not colour converted)
+int decoder_read_frame_yuv(Decoder *dec, YuvFrame **out);
+
+// Same as decoder_read_frame without producing a surface
+int decoder_skip_frame(Decoder *dec);
+
+// Random access (needs a fixed output fps); the next read returns frame `index`
+int decoder_seek_frame(Decoder *dec, int index);
+int decoder_tell(const Decoder *dec);
+
+// Info
+double decoder_get_duration(const Decoder *dec);
+double decoder_get_progress(const Decoder *dec);
+int decoder_estimate_frame_count(const Decoder *dec);
+void decoder_get_output_size(const Decoder *dec, int *width, int *height);
+
+// Manifest helpers
+int decoder_write_manifest(const char *folder, const DecoderManifest *manifest);
+int decoder_read_manifest(const char *folder, DecoderManifest *manifest);
+void decoder_free_manifest(DecoderManifest *manifest);
+
+// Load every frame of an ingest folder (manifest first, legacy PNG frames otherwise)
+SDL_Surface** decoder_load_folder(const char *folder, int *out_count);
+
+// Every frame of a manifest folder as YUV420 (NULL for legacy PNG folders)
+YuvFrame** decoder_load_folder_yuv(const char *folder, int *out_count);
+
+// Queue the PNG frames of a legacy folder on `loader`. Allocates `frames`
+// and returns the frame count.
+int decoder_queue_png_frames(FrameLoader *loader, const char *folder, SDL_Surface ***frames);
+
+#endif // DECODER_H
@@ -0,0 +1,433 @@
+/* Intermediate frame codecs: PNG, QOI, LZ4 raw */
+#include "frame_codec.h"
+
+#include <SDL2/SDL_image.h>
+#include <lz4.h>
+#include <string.h>
+
+#define FRAME_CODEC_COUNT 4
+
+// Throughput counters, indexed by codec
+typedef struct {
+    guint64 bytes;
+    gint64  usec;
+} CodecCounter;
+
+static GMutex       stats_lock;
+static CodecCounter encode_stats[FRAME_CODEC_COUNT];
+static CodecCounter decode_stats[FRAME_CODEC_COUNT];
+
+static void add_stat(CodecCounter *table, FrameCodec codec, guint64 bytes, gint64 start)
+{
+    gint64 elapsed = g_get_monotonic_time() - start;
+    g_mutex_lock(&stats_lock);
+    table[codec].bytes += bytes;
+    table[codec].usec += elapsed;
+    g_mutex_unlock(&stats_lock);
+}
+
+// Selection
+FrameCodec frame_codec_get_default(void)
+{
+    const char *env = g_getenv("PULSRR_FRAME_CODEC");
+    if (env && *env) {
+        FrameCodec codec = frame_codec_from_name(env);
+        if (codec) return codec;
+        g_printerr("[CODEC] Unknown PULSRR_FRAME_CODEC '%s', using %s\n",
+                   env, frame_codec_get_name(FRAME_CODEC_DEFAULT));
+    }
+    return FRAME_CODEC_DEFAULT;
+}
+
+FrameCodec frame_codec_from_name(const char *name)
+{
+    if (!name) return 0;
+    if (g_ascii_strcasecmp(name, "png") == 0) return FRAME_CODEC_PNG;
+    if (g_ascii_strcasecmp(name, "qoi") == 0) return FRAME_CODEC_QOI;
+    if (g_ascii_strcasecmp(name, "lz4") == 0) return FRAME_CODEC_LZ4;
+    return 0;
+}
+
+const char* frame_codec_get_name(FrameCodec codec)
+{
+    switch (codec) {
+        case FRAME_CODEC_PNG: return "PNG";
+        case FRAME_CODEC_QOI: return "QOI";
+        case FRAME_CODEC_LZ4: return "LZ4";
+    }
+    return "?";
+}
+
+gboolean frame_codec_is_valid(guint32 codec)
+{
+    return codec == FRAME_CODEC_PNG || codec == FRAME_CODEC_QOI || codec == FRAME_CODEC_LZ4;
+}
+
+// ---------------------------------------------------------------------------
+// PNG (SDL_image, through an SDL_RWops appending to a GByteArray)
+
+static Sint64 mem_size(SDL_RWops *rw)
+{
+    return ((GByteArray *)rw->hidden.unknown.data1)->len;
+}
+
+static Sint64 mem_seek(SDL_RWops *rw, Sint64 offset, int whence)
+{
+    Sint64 pos = GPOINTER_TO_SIZE(rw->hidden.unknown.data2);
+    if (whence == RW_SEEK_SET) pos = offset;
+    else if (whence == RW_SEEK_CUR) pos += offset;
+    else pos = mem_size(rw) + offset;
+    if (pos < 0) return SDL_SetError("Seek before start");
+    rw->hidden.unknown.data2 = GSIZE_TO_POINTER((gsize)pos);
+    return pos;
+}
+
+static size_t mem_read(SDL_RWops *rw, void *ptr, size_t size, size_t num)
+{
+    (void)rw; (void)ptr; (void)size; (void)num;
+    return 0;
+}
+
+static size_t mem_write(SDL_RWops *rw, const void *ptr, size_t size, size_t num)
+{
+    GByteArray *buf = rw->hidden.unknown.data1;
+    gsize pos = GPOINTER_TO_SIZE(rw->hidden.unknown.data2);
+    gsize len = size * num;
+
+    if (pos + len > buf->len) g_byte_array_set_size(buf, pos + len);
+    memcpy(buf->data + pos, ptr, len);
+    rw->hidden.unknown.data2 = GSIZE_TO_POINTER(pos + len);
+    return num;
+}
+
+static int mem_close(SDL_RWops *rw)
+{
+    SDL_FreeRW(rw);
+    return 0;
+}
+
+static int png_encode(SDL_Surface *frame, GByteArray *out)
+{
+    SDL_RWops *rw = SDL_AllocRW();
+    if (!rw) return -1;
+    rw->size  = mem_size;
+    rw->seek  = mem_seek;
+    rw->read  = mem_read;
+    rw->write = mem_write;
+    rw->close = mem_close;
+    rw->type  = SDL_RWOPS_UNKNOWN;
+    rw->hidden.unknown.data1 = out;
+    rw->hidden.unknown.data2 = GSIZE_TO_POINTER(0);
+
+    return IMG_SavePNG_RW(frame, rw, 1);
+}
+
+static SDL_Surface* png_decode(const void *data, size_t size)
+{
+    SDL_Surface *surf = IMG_Load_RW(SDL_RWFromConstMem(data, (int)size), 1);
+    if (!surf || surf->format->format == SDL_PIXELFORMAT_ARGB8888) return surf;
+
+    SDL_Surface *argb = SDL_ConvertSurfaceFormat(surf, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(surf);
+    return argb;
+}
+
+// ---------------------------------------------------------------------------
+// QOI (https://qoiformat.org/qoi-specification.pdf), 4 channels, sRGB
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF  0x40
+#define QOI_OP_LUMA  0x80
+#define QOI_OP_RUN   0xc0
+#define QOI_OP_RGB   0xfe
+#define QOI_OP_RGBA  0xff
+#define QOI_MASK_2   0xc0
+#define QOI_HEADER_SIZE 14
+
+static const Uint8 qoi_padding[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+typedef union {
+    struct { Uint8 r, g, b, a; } rgba;
+    Uint32 v;
+} QoiPixel;
+
+static inline int qoi_hash(QoiPixel p)
+{
+    return (p.rgba.r * 3 + p.rgba.g * 5 + p.rgba.b * 7 + p.rgba.a * 11) % 64;
+}
+
+static inline void put_be32(Uint8 *p, Uint32 v)
+{
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static inline Uint32 get_be32(const Uint8 *p)
+{
+    return ((Uint32)p[0] << 24) | ((Uint32)p[1] << 16) | ((Uint32)p[2] << 8) | p[3];
+}
+
+static int qoi_encode(SDL_Surface *frame, GByteArray *out)
+{
+    int w = frame->w, h = frame->h;
+    g_byte_array_set_size(out, (guint)w * h * 5 + QOI_HEADER_SIZE + sizeof(qoi_padding));
+    Uint8 *bytes = out->data;
+    size_t p = 0;
+
+    memcpy(bytes, "qoif", 4);
+    put_be32(bytes + 4, w);
+    put_be32(bytes + 8, h);
+    bytes[12] = 4;  // channels
+    bytes[13] = 0;  // sRGB with linear alpha
+    p = QOI_HEADER_SIZE;
+
+    QoiPixel index[64];
+    memset(index, 0, sizeof(index));
+    QoiPixel prev = { .rgba = {0, 0, 0, 255} };
+    int run = 0;
+
+    for (int y = 0; y < h; y++) {
+        const Uint32 *row = (const Uint32 *)((const Uint8 *)frame->pixels + y * frame->pitch);
+        for (int x = 0; x < w; x++) {
+            Uint32 argb = row[x];
+            QoiPixel px = { .rgba = { argb >> 16, argb >> 8, argb, argb >> 24 } };
+            int last = (y == h - 1 && x == w - 1);
+
+            if (px.v == prev.v) {
+                if (++run == 62 || last) {
+                    bytes[p++] = QOI_OP_RUN | (run - 1);
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0) {
+                bytes[p++] = QOI_OP_RUN | (run - 1);
+                run = 0;
+            }
+
+            int h_pos = qoi_hash(px);
+            if (index[h_pos].v == px.v) {
+                bytes[p++] = QOI_OP_INDEX | h_pos;
+            } else {
+                index[h_pos] = px;
+
+                if (px.rgba.a == prev.rgba.a) {
+                    signed char vr = px.rgba.r - prev.rgba.r;
+                    signed char vg = px.rgba.g - prev.rgba.g;
+                    signed char vb = px.rgba.b - prev.rgba.b;
+                    signed char vg_r = vr - vg;
+                    signed char vg_b = vb - vg;
+
+                    if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                        bytes[p++] = QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+                    } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+                        bytes[p++] = QOI_OP_LUMA | (vg + 32);
+                        bytes[p++] = (vg_r + 8) << 4 | (vg_b + 8);
+                    } else {
+                        bytes[p++] = QOI_OP_RGB;
+                        bytes[p++] = px.rgba.r;
+                        bytes[p++] = px.rgba.g;
+                        bytes[p++] = px.rgba.b;
+                    }
+                } else {
+                    bytes[p++] = QOI_OP_RGBA;
+                    bytes[p++] = px.rgba.r;
+                    bytes[p++] = px.rgba.g;
+                    bytes[p++] = px.rgba.b;
+                    bytes[p++] = px.rgba.a;
+                }
+            }
+            prev = px;
+        }
+    }
+
+    memcpy(bytes + p, qoi_padding, sizeof(qoi_padding));
+    p += sizeof(qoi_padding);
+    g_byte_array_set_size(out, p);
+    return 0;
+}
+
+static SDL_Surface* qoi_decode(const void *data, size_t size, int width, int height)
+{
+    const Uint8 *bytes = data;
+    if (size < QOI_HEADER_SIZE + sizeof(qoi_padding) || memcmp(bytes, "qoif", 4) != 0) return NULL;
+
+    int w = get_be32(bytes + 4), h = get_be32(bytes + 8);
+    if (w != width || h != height) return NULL;
+
+    SDL_Surface *surf = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surf) return NULL;
+
+    QoiPixel index[64];
+    memset(index, 0, sizeof(index));
+    QoiPixel px = { .rgba = {0, 0, 0, 255} };
+    size_t p = QOI_HEADER_SIZE;
+    size_t chunks_end = size - sizeof(qoi_padding);
+    int run = 0;
+
+    for (int y = 0; y < h; y++) {
+        Uint32 *row = (Uint32 *)((Uint8 *)surf->pixels + y * surf->pitch);
+        for (int x = 0; x < w; x++) {
+            if (run > 0) {
+                run--;
+            } else if (p < chunks_end) {
+                int b1 = bytes[p++];
+
+                if (b1 == QOI_OP_RGB) {
+                    px.rgba.r = bytes[p++];
+                    px.rgba.g = bytes[p++];
+                    px.rgba.b = bytes[p++];
+                } else if (b1 == QOI_OP_RGBA) {
+                    px.rgba.r = bytes[p++];
+                    px.rgba.g = bytes[p++];
+                    px.rgba.b = bytes[p++];
+                    px.rgba.a = bytes[p++];
+                } else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX) {
+                    px = index[b1];
+                } else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF) {
+                    px.rgba.r += ((b1 >> 4) & 0x03) - 2;
+                    px.rgba.g += ((b1 >> 2) & 0x03) - 2;
+                    px.rgba.b += ( b1       & 0x03) - 2;
+                } else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA) {
+                    int b2 = bytes[p++];
+                    int vg = (b1 & 0x3f) - 32;
+                    px.rgba.r += vg - 8 + ((b2 >> 4) & 0x0f);
+                    px.rgba.g += vg;
+                    px.rgba.b += vg - 8 +  (b2       & 0x0f);
+                } else {
+                    run = b1 & 0x3f;
+                }
+
+                index[qoi_hash(px)] = px;
+            } else {
+                // Truncated stream
+                SDL_FreeSurface(surf);
+                return NULL;
+            }
+
+            row[x] = (Uint32)px.rgba.a << 24 | (Uint32)px.rgba.r << 16 | (Uint32)px.rgba.g << 8 | px.rgba.b;
+        }
+    }
+
+    return surf;
+}
+
+// ---------------------------------------------------------------------------
+// LZ4 over tightly packed ARGB8888 rows
+
+static int lz4_encode(SDL_Surface *frame, GByteArray *out)
+{
+    int row_bytes = frame->w * 4;
+    int raw_size = row_bytes * frame->h;
+
+    // Surfaces are normally unpadded; repack otherwise
+    const char *raw = frame->pixels;
+    char *packed = NULL;
+    if (frame->pitch != row_bytes) {
+        packed = g_malloc(raw_size);
+        for (int y = 0; y < frame->h; y++)
+            memcpy(packed + y * row_bytes, (const char *)frame->pixels + y * frame->pitch, row_bytes);
+        raw = packed;
+    }
+
+    g_byte_array_set_size(out, LZ4_compressBound(raw_size));
+    int n = LZ4_compress_default(raw, (char *)out->data, raw_size, out->len);
+    g_free(packed);
+
+    if (n <= 0) return -1;
+    g_byte_array_set_size(out, n);
+    return 0;
+}
+
+static SDL_Surface* lz4_decode(const void *data, size_t size, int width, int height)
+{
+    SDL_Surface *surf = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surf) return NULL;
+
+    int row_bytes = width * 4;
+    int raw_size = row_bytes * height;
+    char *dst = surf->pitch == row_bytes ? surf->pixels : g_malloc(raw_size);
+
+    int n = LZ4_decompress_safe(data, dst, (int)size, raw_size);
+    if (dst != surf->pixels) {
+        for (int y = 0; y < height && n == raw_size; y++)
+            memcpy((char *)surf->pixels + y * surf->pitch, dst + y * row_bytes, row_bytes);
+        g_free(dst);
+    }
+
+    if (n != raw_size) {
+        SDL_FreeSurface(surf);
+        return NULL;
+    }
+    return surf;
+}
+
+// ---------------------------------------------------------------------------
+
+int frame_codec_encode(FrameCodec codec, SDL_Surface *frame, GByteArray *out)
+{
+    if (!frame || !out || frame->format->format != SDL_PIXELFORMAT_ARGB8888) return -1;
+
+    gint64 start = g_get_monotonic_time();
+    int ret;
+    g_byte_array_set_size(out, 0);
+
+    switch (codec) {
+        case FRAME_CODEC_PNG: ret = png_encode(frame, out); break;
+        case FRAME_CODEC_QOI: ret = qoi_encode(frame, out); break;
+        case FRAME_CODEC_LZ4: ret = lz4_encode(frame, out); break;
+        default: return -1;
+    }
+
+    if (ret == 0)
+        add_stat(encode_stats, codec, (guint64)frame->w * frame->h * 4, start);
+    return ret;
+}
+
+SDL_Surface* frame_codec_decode(FrameCodec codec, const void *data, size_t size, int width, int height)
+{
+    if (!data || size == 0) return NULL;
+
+    gint64 start = g_get_monotonic_time();
+    SDL_Surface *surf = NULL;
+
+    switch (codec) {
+        case FRAME_CODEC_PNG: surf = png_decode(data, size); break;
+        case FRAME_CODEC_QOI: surf = qoi_decode(data, size, width, height); break;
+        case FRAME_CODEC_LZ4: surf = lz4_decode(data, size, width, height); break;
+        default: return NULL;
+    }
+
+    if (surf)
+        add_stat(decode_stats, codec, (guint64)surf->w * surf->h * 4, start);
+    return surf;
+}
+
+// Throughput
+void frame_codec_reset_stats(void)
+{
+    g_mutex_lock(&stats_lock);
+    memset(encode_stats, 0, sizeof(encode_stats));
+    memset(decode_stats, 0, sizeof(decode_stats));
+    g_mutex_unlock(&stats_lock);
+}
+
+static double mb_per_sec(const CodecCounter *c)
+{
+    return c->usec > 0 ? (c->bytes / (1024.0 * 1024.0)) / (c->usec / 1e6) : 0.0;
+}
+
+gchar* frame_codec_stats_summary(FrameCodec codec)
+{
+    if (!frame_codec_is_valid(codec)) return g_strdup("[CODEC] Unknown codec");
+
+    g_mutex_lock(&stats_lock);
+    CodecCounter enc = encode_stats[codec];
+    CodecCounter dec = decode_stats[codec];
+    g_mutex_unlock(&stats_lock);
+
+    return g_strdup_printf("[CODEC] %s: encode %.1f MB/s (%.1f MB), decode %.1f MB/s (%.1f MB)",
+                           frame_codec_get_name(codec),
+                           mb_per_sec(&enc), enc.bytes / (1024.0 * 1024.0),
+                           mb_per_sec(&dec), dec.bytes / (1024.0 * 1024.0));
+}
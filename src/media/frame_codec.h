@@ -0,0 +1,32 @@
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+// Intermediate frame codecs (values are stored in frame packs, keep them stable)
+typedef enum {
+    FRAME_CODEC_PNG = 1,    // zlib, interoperable
+    FRAME_CODEC_QOI = 2,    // "Quite OK Image", lossless, fast both ways
+    FRAME_CODEC_LZ4 = 3     // raw ARGB8888 rows, LZ4 block compressed
+} FrameCodec;
+
+#define FRAME_CODEC_DEFAULT FRAME_CODEC_QOI
+
+// Selection (PULSRR_FRAME_CODEC=png|qoi|lz4 overrides the default)
+FrameCodec frame_codec_get_default(void);
+FrameCodec frame_codec_from_name(const char *name);
+const char* frame_codec_get_name(FrameCodec codec);
+gboolean frame_codec_is_valid(guint32 codec);
+
+// Encode an ARGB8888 surface, replacing the contents of `out`
+int frame_codec_encode(FrameCodec codec, SDL_Surface *frame, GByteArray *out);
+
+// Decode a payload into a new ARGB8888 surface of the given size
+SDL_Surface* frame_codec_decode(FrameCodec codec, const void *data, size_t size, int width, int height);
+
+// Throughput counters (raw pixel bytes per second of codec time)
+void frame_codec_reset_stats(void);
+gchar* frame_codec_stats_summary(FrameCodec codec);
+
+#endif // FRAME_CODEC_H
@@ -0,0 +1,165 @@
+/* Parallel, order-preserving frame loading */
+#include "frame_loader.h"
+
+#include <SDL2/SDL_image.h>
+
+struct FrameLoader {
+    GMutex          lock;
+    GCond           idle;
+    gint            total;
+    gint            done;
+    gint            ready;      // jobs finished in queue order (contiguous prefix)
+    GArray         *finished;   // gboolean per job, in queue order
+    gint            cancelled;
+};
+
+typedef struct {
+    FrameLoader     *loader;
+    int              seq;       // position in the queue
+    gchar           *path;
+    const FramePack *pack;
+    int              index;
+    SDL_Surface    **slot;
+} LoadJob;
+
+static GThreadPool *pool = NULL;
+static GMutex       pool_lock;
+
+static SDL_Surface* load_file(const char *path)
+{
+    SDL_Surface *surf = IMG_Load(path);
+    if (!surf) {
+        g_printerr("[LOADER] %s: %s\n", path, IMG_GetError());
+        return NULL;
+    }
+    if (surf->format->format == SDL_PIXELFORMAT_ARGB8888) return surf;
+
+    SDL_Surface *argb = SDL_ConvertSurfaceFormat(surf, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(surf);
+    return argb;
+}
+
+static void run_job(gpointer data, gpointer user_data)
+{
+    (void)user_data;
+    LoadJob *job = data;
+    FrameLoader *loader = job->loader;
+
+    // Cancelled jobs still complete, leaving their slots empty
+    if (!g_atomic_int_get(&loader->cancelled))
+        *job->slot = job->pack ? frame_pack_read_frame(job->pack, job->index)
+                               : load_file(job->path);
+
+    g_mutex_lock(&loader->lock);
+    g_array_index(loader->finished, gboolean, job->seq) = TRUE;
+    while (loader->ready < (gint)loader->finished->len &&
+           g_array_index(loader->finished, gboolean, loader->ready))
+        loader->ready++;
+    if (++loader->done == loader->total)
+        g_cond_broadcast(&loader->idle);
+    g_mutex_unlock(&loader->lock);
+
+    g_free(job->path);
+    g_free(job);
+}
+
+static GThreadPool* get_pool(void)
+{
+    g_mutex_lock(&pool_lock);
+    if (!pool) {
+        int threads = MAX((int)g_get_num_processors(), 1);
+        pool = g_thread_pool_new(run_job, NULL, threads, FALSE, NULL);
+    }
+    g_mutex_unlock(&pool_lock);
+    return pool;
+}
+
+FrameLoader* frame_loader_new(void)
+{
+    FrameLoader *loader = g_new0(FrameLoader, 1);
+    g_mutex_init(&loader->lock);
+    g_cond_init(&loader->idle);
+    loader->finished = g_array_new(FALSE, TRUE, sizeof(gboolean));
+    return loader;
+}
+
+void frame_loader_free(FrameLoader *loader)
+{
+    if (!loader) return;
+    frame_loader_wait(loader);
+    g_array_free(loader->finished, TRUE);
+    g_mutex_clear(&loader->lock);
+    g_cond_clear(&loader->idle);
+    g_free(loader);
+}
+
+static void queue_job(FrameLoader *loader, LoadJob *job)
+{
+    g_mutex_lock(&loader->lock);
+    job->seq = loader->total++;
+    g_array_set_size(loader->finished, loader->total);
+    g_mutex_unlock(&loader->lock);
+
+    g_thread_pool_push(get_pool(), job, NULL);
+}
+
+void frame_loader_add_file(FrameLoader *loader, const char *path, SDL_Surface **slot)
+{
+    if (!loader || !path || !slot) return;
+
+    LoadJob *job = g_new0(LoadJob, 1);
+    job->loader = loader;
+    job->path = g_strdup(path);
+    job->slot = slot;
+    queue_job(loader, job);
+}
+
+void frame_loader_add_pack(FrameLoader *loader, const FramePack *pack, int index,
+                           SDL_Surface **slot)
+{
+    if (!loader || !pack || !slot) return;
+
+    LoadJob *job = g_new0(LoadJob, 1);
+    job->loader = loader;
+    job->pack = pack;
+    job->index = index;
+    job->slot = slot;
+    queue_job(loader, job);
+}
+
+void frame_loader_wait(FrameLoader *loader)
+{
+    g_mutex_lock(&loader->lock);
+    while (loader->done < loader->total)
+        g_cond_wait(&loader->idle, &loader->lock);
+    g_mutex_unlock(&loader->lock);
+}
+
+void frame_loader_cancel(FrameLoader *loader)
+{
+    if (loader) g_atomic_int_set(&loader->cancelled, 1);
+}
+
+int frame_loader_get_ready(FrameLoader *loader)
+{
+    g_mutex_lock(&loader->lock);
+    int ready = loader->ready;
+    g_mutex_unlock(&loader->lock);
+    return ready;
+}
+
+int frame_loader_get_done(FrameLoader *loader)
+{
+    g_mutex_lock(&loader->lock);
+    int done = loader->done;
+    g_mutex_unlock(&loader->lock);
+    return done;
+}
+
+int frame_loader_get_total(FrameLoader *loader)
+{
+    g_mutex_lock(&loader->lock);
+    int total = loader->total;
+    g_mutex_unlock(&loader->lock);
+    return total;
+}
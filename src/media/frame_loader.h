@@ -0,0 +1,33 @@
+#ifndef FRAME_LOADER_H
+#define FRAME_LOADER_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+#include "frame_pack.h"
+
+// Parallel frame loading on a shared pool sized to the CPU count.
+// Each job decodes into a caller-owned slot, so completion order does not
+// matter and the frame array keeps its order.
+typedef struct FrameLoader FrameLoader;
+
+FrameLoader* frame_loader_new(void);
+void frame_loader_free(FrameLoader *loader);
+
+// Queue jobs
+void frame_loader_add_file(FrameLoader *loader, const char *path, SDL_Surface **slot);
+void frame_loader_add_pack(FrameLoader *loader, const FramePack *pack, int index,
+                           SDL_Surface **slot);
+
+// Block until every queued job is done
+void frame_loader_wait(FrameLoader *loader);
+
+// Skip the decode of jobs that have not started yet
+void frame_loader_cancel(FrameLoader *loader);
+
+// Number of jobs finished in queue order: the slots of the first N jobs
+// are written and safe to read from the calling thread
+int frame_loader_get_ready(FrameLoader *loader);
+int frame_loader_get_done(FrameLoader *loader);
+int frame_loader_get_total(FrameLoader *loader);
+
+#endif // FRAME_LOADER_H
@@ -0,0 +1,250 @@
+/* Packed frame container (header + payloads + mmap'd index) */
+#include "frame_pack.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define FRAME_PACK_MAGIC   "PULSPACK"
+#define FRAME_PACK_VERSION 1
+
+// On-disk structures (little-endian, naturally aligned)
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t codec;
+    uint32_t frame_count;
+    uint32_t width;
+    uint32_t height;
+    uint32_t fps;
+    uint64_t index_offset;
+} FramePackHeader;
+
+typedef struct {
+    uint64_t offset;
+    uint32_t size;
+    uint32_t reserved;
+} FramePackEntry;
+
+G_STATIC_ASSERT(sizeof(FramePackHeader) == 40);
+G_STATIC_ASSERT(sizeof(FramePackEntry) == 16);
+
+struct FramePackWriter {
+    FILE    *file;
+    gchar   *path;       // final name
+    gchar   *tmp_path;   // written here, renamed on finish
+    GArray  *index;      // FramePackEntry
+    uint64_t offset;
+    FramePackHeader header;
+    GByteArray *buffer;  // scratch for one encoded frame
+};
+
+struct FramePack {
+    const uint8_t        *data;
+    size_t                size;
+    const FramePackHeader *header;
+    const FramePackEntry  *index;
+};
+
+// Writer
+FramePackWriter* frame_pack_create(const char *path, FrameCodec codec, int width, int height, int fps)
+{
+    if (!path || !frame_codec_is_valid(codec) || width <= 0 || height <= 0) return NULL;
+
+    FramePackWriter *w = g_new0(FramePackWriter, 1);
+    w->path = g_strdup(path);
+    w->tmp_path = g_strconcat(path, ".tmp", NULL);
+    w->file = fopen(w->tmp_path, "wb");
+    if (!w->file) {
+        g_printerr("[PACK] Cannot create %s\n", w->tmp_path);
+        g_free(w->path);
+        g_free(w->tmp_path);
+        g_free(w);
+        return NULL;
+    }
+
+    memcpy(w->header.magic, FRAME_PACK_MAGIC, sizeof(w->header.magic));
+    w->header.version = FRAME_PACK_VERSION;
+    w->header.codec = codec;
+    w->header.width = width;
+    w->header.height = height;
+    w->header.fps = fps > 0 ? fps : 0;
+
+    // Placeholder header, rewritten once the index is known
+    fwrite(&w->header, sizeof(w->header), 1, w->file);
+    w->offset = sizeof(w->header);
+    w->index = g_array_new(FALSE, FALSE, sizeof(FramePackEntry));
+    w->buffer = g_byte_array_new();
+    return w;
+}
+
+int frame_pack_append(FramePackWriter *w, SDL_Surface *frame)
+{
+    if (!w || !frame) return -1;
+
+    if (frame_codec_encode(w->header.codec, frame, w->buffer) != 0) {
+        g_printerr("[PACK] Frame %u encode failed: %s\n", w->index->len + 1, SDL_GetError());
+        return -1;
+    }
+
+    return frame_pack_append_encoded(w, w->buffer->data, w->buffer->len);
+}
+
+int frame_pack_append_encoded(FramePackWriter *w, const void *data, size_t size)
+{
+    if (!w || !data) return -1;
+
+    if (fwrite(data, 1, size, w->file) != size) {
+        g_printerr("[PACK] Write failed on %s\n", w->tmp_path);
+        return -1;
+    }
+
+    FramePackEntry entry = { .offset = w->offset, .size = size };
+    g_array_append_val(w->index, entry);
+    w->offset += size;
+    return 0;
+}
+
+static void writer_free(FramePackWriter *w)
+{
+    g_array_free(w->index, TRUE);
+    g_byte_array_free(w->buffer, TRUE);
+    g_free(w->path);
+    g_free(w->tmp_path);
+    g_free(w);
+}
+
+int frame_pack_finish(FramePackWriter *w)
+{
+    if (!w) return -1;
+
+    w->header.frame_count = w->index->len;
+    w->header.index_offset = w->offset;
+
+    int ok = fwrite(w->index->data, sizeof(FramePackEntry), w->index->len, w->file) == w->index->len
+          && fseek(w->file, 0, SEEK_SET) == 0
+          && fwrite(&w->header, sizeof(w->header), 1, w->file) == 1
+          && fflush(w->file) == 0
+          && fsync(fileno(w->file)) == 0;
+    ok = (fclose(w->file) == 0) && ok;
+
+    if (!ok || rename(w->tmp_path, w->path) != 0) {
+        g_printerr("[PACK] Cannot finalize %s\n", w->path);
+        unlink(w->tmp_path);
+        writer_free(w);
+        return -1;
+    }
+
+    writer_free(w);
+    return 0;
+}
+
+void frame_pack_abort(FramePackWriter *w)
+{
+    if (!w) return;
+    fclose(w->file);
+    unlink(w->tmp_path);
+    writer_free(w);
+}
+
+// Reader
+FramePack* frame_pack_open(const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FramePackHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        g_printerr("[PACK] mmap failed on %s\n", path);
+        return NULL;
+    }
+
+    const FramePackHeader *h = data;
+    size_t size = st.st_size;
+    size_t index_bytes = (size_t)h->frame_count * sizeof(FramePackEntry);
+
+    if (memcmp(h->magic, FRAME_PACK_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != FRAME_PACK_VERSION ||
+        !frame_codec_is_valid(h->codec) ||
+        h->index_offset < sizeof(FramePackHeader) ||
+        h->index_offset > size || index_bytes > size - h->index_offset) {
+        g_printerr("[PACK] %s is not a valid frame pack\n", path);
+        munmap(data, size);
+        return NULL;
+    }
+
+    FramePack *pack = g_new0(FramePack, 1);
+    pack->data = data;
+    pack->size = size;
+    pack->header = h;
+    pack->index = (const FramePackEntry *)(pack->data + h->index_offset);
+
+    // Readers walk frames in order
+    posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+    return pack;
+}
+
+void frame_pack_close(FramePack *pack)
+{
+    if (!pack) return;
+    munmap((void *)pack->data, pack->size);
+    g_free(pack);
+}
+
+int frame_pack_get_frame_count(const FramePack *pack)
+{
+    return pack ? (int)pack->header->frame_count : 0;
+}
+
+int frame_pack_get_fps(const FramePack *pack)
+{
+    return pack ? (int)pack->header->fps : 0;
+}
+
+FrameCodec frame_pack_get_codec(const FramePack *pack)
+{
+    return pack ? (FrameCodec)pack->header->codec : 0;
+}
+
+void frame_pack_get_size(const FramePack *pack, int *width, int *height)
+{
+    if (width)  *width  = pack ? (int)pack->header->width : 0;
+    if (height) *height = pack ? (int)pack->header->height : 0;
+}
+
+const void* frame_pack_get_payload(const FramePack *pack, int index, size_t *size)
+{
+    if (!pack || index < 0 || index >= (int)pack->header->frame_count) return NULL;
+
+    const FramePackEntry *e = &pack->index[index];
+    if (e->offset > pack->header->index_offset ||
+        e->size > pack->header->index_offset - e->offset)
+        return NULL;
+
+    if (size) *size = e->size;
+    return pack->data + e->offset;
+}
+
+SDL_Surface* frame_pack_read_frame(const FramePack *pack, int index)
+{
+    size_t size = 0;
+    const void *payload = frame_pack_get_payload(pack, index, &size);
+    if (!payload) return NULL;
+
+    const FramePackHeader *h = pack->header;
+    SDL_Surface *surf = frame_codec_decode(h->codec, payload, size, h->width, h->height);
+    if (!surf)
+        g_printerr("[PACK] Frame %d decode failed (%s)\n", index + 1, frame_codec_get_name(h->codec));
+    return surf;
+}
@@ -0,0 +1,39 @@
+#ifndef FRAME_PACK_H
+#define FRAME_PACK_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+#include "frame_codec.h"
+
+// Single-file frame container written by the bake (sequence_N/frames.pack).
+// Layout: header | frame payloads | index of (offset, size) per frame.
+#define FRAME_PACK_NAME "frames.pack"
+
+typedef struct FramePack FramePack;
+typedef struct FramePackWriter FramePackWriter;
+
+// Writer: frames are appended, the index is written on finish
+FramePackWriter* frame_pack_create(const char *path, FrameCodec codec, int width, int height, int fps);
+int frame_pack_append(FramePackWriter *writer, SDL_Surface *frame);
+// Payload already encoded with the pack's codec (parallel bakes encode on
+// their workers and append in frame order)
+int frame_pack_append_encoded(FramePackWriter *writer, const void *data, size_t size);
+int frame_pack_finish(FramePackWriter *writer);
+void frame_pack_abort(FramePackWriter *writer);
+
+// Reader: the whole file is mmap'd, frames are decoded on request
+FramePack* frame_pack_open(const char *path);
+void frame_pack_close(FramePack *pack);
+
+int frame_pack_get_frame_count(const FramePack *pack);
+int frame_pack_get_fps(const FramePack *pack);
+FrameCodec frame_pack_get_codec(const FramePack *pack);
+void frame_pack_get_size(const FramePack *pack, int *width, int *height);
+
+// Encoded payload of frame `index` (points into the mapping)
+const void* frame_pack_get_payload(const FramePack *pack, int index, size_t *size);
+
+// Decode frame `index` as an ARGB8888 surface
+SDL_Surface* frame_pack_read_frame(const FramePack *pack, int index);
+
+#endif // FRAME_PACK_H
@@ -0,0 +1,308 @@
+/* Streaming frame cache for live layers */
+#include "frame_ring.h"
+
+#include <string.h>
+#include <math.h>
+
+typedef struct {
+    int          index;     // clip frame held by this slot (-1 = free)
+    SDL_Surface *surface;   // FRAME_FORMAT_ARGB8888
+    YuvFrame    *yuv;       // FRAME_FORMAT_YUV420
+} RingSlot;
+
+struct FrameRing {
+    GMutex   lock;
+    GCond    wake;
+    GThread *thread;
+    gboolean running;
+
+    RingSlot *slots;
+    int       capacity;
+    FrameFormat format;
+
+    Decoder  *decoder;
+    int       frame_count;  // shrinks if the clip ends before the manifest says
+    int       width;
+    int       height;
+
+    int       playhead;
+    double    step;         // source frames advanced per displayed frame
+};
+
+// Frame `k` positions ahead of the playhead in playback order
+static int ahead_index(const FrameRing *ring, int k)
+{
+    long offset = lround(k * ring->step);
+    return (int)((ring->playhead + offset) % ring->frame_count);
+}
+
+// Is `index` among the next `capacity` frames that will be shown?
+static gboolean is_wanted(const FrameRing *ring, int index)
+{
+    if (index < 0 || index >= ring->frame_count) return FALSE;
+    int distance = (index - ring->playhead + ring->frame_count) % ring->frame_count;
+    return distance < (int)lround(ring->capacity * ring->step);
+}
+
+static RingSlot* find_slot(FrameRing *ring, int index)
+{
+    for (int i = 0; i < ring->capacity; i++)
+        if (ring->slots[i].index == index) return &ring->slots[i];
+    return NULL;
+}
+
+static void clear_slot(RingSlot *slot)
+{
+    SDL_FreeSurface(slot->surface);
+    yuv_frame_free(slot->yuv);
+    slot->surface = NULL;
+    slot->yuv = NULL;
+    slot->index = -1;
+}
+
+// Free slot, evicting frames that fell out of the window
+static RingSlot* take_free_slot(FrameRing *ring)
+{
+    for (int i = 0; i < ring->capacity; i++) {
+        RingSlot *slot = &ring->slots[i];
+        if (slot->index >= 0 && !is_wanted(ring, slot->index))
+            clear_slot(slot);
+        if (slot->index < 0) return slot;
+    }
+    return NULL;
+}
+
+// Next frame to prefetch, or -1 when the window is full
+static int next_missing(FrameRing *ring)
+{
+    for (int k = 0; k < ring->capacity; k++) {
+        int index = ahead_index(ring, k);
+        if (!find_slot(ring, index)) return index;
+    }
+    return -1;
+}
+
+// Decode frame `index` into `slot` fields (called without the lock held)
+static gboolean read_frame(FrameRing *ring, int index, RingSlot *out)
+{
+    int pos = decoder_tell(ring->decoder);
+
+    // Seek on backward jumps and on forward gaps larger than a second or so
+    if (index < pos || index - pos > ring->capacity) {
+        if (decoder_seek_frame(ring->decoder, index) != 0) return FALSE;
+        pos = index;
+    }
+
+    while (pos < index) {
+        if (decoder_skip_frame(ring->decoder) <= 0) return FALSE;
+        pos++;
+    }
+
+    if (ring->format == FRAME_FORMAT_YUV420)
+        return decoder_read_frame_yuv(ring->decoder, &out->yuv) > 0;
+    return decoder_read_frame(ring->decoder, &out->surface) > 0;
+}
+
+static gpointer prefetch_thread(gpointer data)
+{
+    FrameRing *ring = data;
+
+    g_mutex_lock(&ring->lock);
+    while (ring->running) {
+        int index = next_missing(ring);
+        if (index < 0 || !take_free_slot(ring)) {
+            g_cond_wait(&ring->wake, &ring->lock);
+            continue;
+        }
+
+        g_mutex_unlock(&ring->lock);
+        RingSlot decoded = { index, NULL, NULL };
+        gboolean ok = read_frame(ring, index, &decoded);
+        g_mutex_lock(&ring->lock);
+
+        if (!ok) {
+            // Clip shorter than announced: clamp and keep going
+            if (index > 0 && index < ring->frame_count) {
+                g_printerr("[RING] Clip ends at frame %d (expected %d)\n", index, ring->frame_count);
+                ring->frame_count = index;
+                if (ring->playhead >= index) ring->playhead = 0;
+                continue;
+            }
+            g_printerr("[RING] Frame %d could not be decoded, prefetch stopped\n", index);
+            break;
+        }
+
+        // The window may have moved while decoding
+        RingSlot *slot = is_wanted(ring, index) && !find_slot(ring, index) ? take_free_slot(ring) : NULL;
+        if (!slot) {
+            clear_slot(&decoded);
+            continue;
+        }
+        *slot = decoded;
+    }
+    g_mutex_unlock(&ring->lock);
+
+    return NULL;
+}
+
+// Create / destroy
+FrameRing* frame_ring_new(const DecoderManifest *manifest, int capacity, FrameFormat format)
+{
+    if (!manifest || !manifest->source || capacity <= 0) return NULL;
+
+    Decoder *dec = decoder_open(manifest->source, manifest->fps, manifest->width);
+    if (!dec) return NULL;
+
+    int frame_count = manifest->frame_count > 0 ? manifest->frame_count
+                                                : decoder_estimate_frame_count(dec);
+    if (frame_count <= 0) {
+        decoder_close(dec);
+        return NULL;
+    }
+
+    FrameRing *ring = g_new0(FrameRing, 1);
+    g_mutex_init(&ring->lock);
+    g_cond_init(&ring->wake);
+    ring->decoder = dec;
+    ring->frame_count = frame_count;
+    ring->capacity = MIN(capacity, frame_count);
+    ring->format = format;
+    ring->step = 1.0;
+    decoder_get_output_size(dec, &ring->width, &ring->height);
+
+    ring->slots = g_new0(RingSlot, ring->capacity);
+    for (int i = 0; i < ring->capacity; i++)
+        ring->slots[i].index = -1;
+
+    ring->running = TRUE;
+    ring->thread = g_thread_new("frame-ring", prefetch_thread, ring);
+    return ring;
+}
+
+void frame_ring_free(FrameRing *ring)
+{
+    if (!ring) return;
+
+    g_mutex_lock(&ring->lock);
+    ring->running = FALSE;
+    g_cond_signal(&ring->wake);
+    g_mutex_unlock(&ring->lock);
+    g_thread_join(ring->thread);
+
+    for (int i = 0; i < ring->capacity; i++)
+        clear_slot(&ring->slots[i]);
+    g_free(ring->slots);
+
+    decoder_close(ring->decoder);
+    g_mutex_clear(&ring->lock);
+    g_cond_clear(&ring->wake);
+    g_free(ring);
+}
+
+// Playback side
+void frame_ring_set_playhead(FrameRing *ring, int frame, double speed)
+{
+    if (!ring) return;
+
+    // Layers only play forward; speeds below 1 repeat frames, above 1 skip them
+    double step = fabs(speed) < 1.0 ? 1.0 : fabs(speed);
+
+    g_mutex_lock(&ring->lock);
+    if (frame >= 0 && frame < ring->frame_count &&
+        (frame != ring->playhead || step != ring->step)) {
+        ring->playhead = frame;
+        ring->step = step;
+        g_cond_signal(&ring->wake);
+    }
+    g_mutex_unlock(&ring->lock);
+}
+
+// Copy frame `frame` into a streaming texture. Returns 0 when the frame was
+// not decoded yet (caller keeps showing the previous one). YUV420 frames go
+// to SDL_PIXELFORMAT_IYUV textures as planes, anything else is ARGB8888.
+int frame_ring_upload(FrameRing *ring, int frame, SDL_Texture *texture, const FxChain *fx)
+{
+    if (!ring || !texture) return -1;
+
+    g_mutex_lock(&ring->lock);
+    RingSlot *slot = find_slot(ring, frame);
+    if (!slot) {
+        g_mutex_unlock(&ring->lock);
+        return 0;
+    }
+
+    int ret = 1;
+    Uint32 format = 0;
+    SDL_QueryTexture(texture, &format, NULL, NULL, NULL);
+
+    if (slot->yuv && format == SDL_PIXELFORMAT_IYUV) {
+        // Planes go up as they are, the GPU converts
+        const YuvFrame *yuv = slot->yuv;
+        if (SDL_UpdateYUVTexture(texture, NULL, yuv->planes[0], yuv->pitches[0],
+                                 yuv->planes[1], yuv->pitches[1],
+                                 yuv->planes[2], yuv->pitches[2]) != 0)
+            ret = -1;
+    } else if (slot->surface && (!fx || fx->identity)) {
+        SDL_Surface *src = slot->surface;
+        if (SDL_UpdateTexture(texture, NULL, src->pixels, src->pitch) != 0) ret = -1;
+    } else {
+        // FX (and YUV frames on an ARGB texture) are converted row by row
+        void *pixels;
+        int pitch;
+        if (SDL_LockTexture(texture, NULL, &pixels, &pitch) != 0) {
+            ret = -1;
+        } else {
+            for (int y = 0; y < ring->height; y++) {
+                Uint32 *out = (Uint32 *)((Uint8 *)pixels + y * pitch);
+                if (slot->yuv) {
+                    yuv_frame_row_to_argb(slot->yuv, y, out);
+                    if (fx && !fx->identity) fx_chain_apply_row(fx, out, out, ring->width);
+                } else {
+                    const Uint8 *row = (const Uint8 *)slot->surface->pixels + y * slot->surface->pitch;
+                    fx_chain_apply_row(fx, (const Uint32 *)row, out, ring->width);
+                }
+            }
+            SDL_UnlockTexture(texture);
+        }
+    }
+
+    g_mutex_unlock(&ring->lock);
+    return ret;
+}
+
+// Info
+int frame_ring_get_frame_count(FrameRing *ring)
+{
+    if (!ring) return 0;
+    g_mutex_lock(&ring->lock);
+    int count = ring->frame_count;
+    g_mutex_unlock(&ring->lock);
+    return count;
+}
+
+int frame_ring_get_capacity(const FrameRing *ring)
+{
+    return ring ? ring->capacity : 0;
+}
+
+int frame_ring_get_ready_count(FrameRing *ring)
+{
+    if (!ring) return 0;
+    g_mutex_lock(&ring->lock);
+    int ready = 0;
+    for (int i = 0; i < ring->capacity; i++)
+        if (ring->slots[i].index >= 0) ready++;
+    g_mutex_unlock(&ring->lock);
+    return ready;
+}
+
+void frame_ring_get_size(const FrameRing *ring, int *width, int *height)
+{
+    if (width)  *width  = ring ? ring->width : 0;
+    if (height) *height = ring ? ring->height : 0;
+}
+
+FrameFormat frame_ring_get_format(const FrameRing *ring)
+{
+    return ring ? ring->format : FRAME_FORMAT_ARGB8888;
+}
@@ -0,0 +1,31 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+#include "decoder.h"
+#include "fx_chain.h"
+
+// Bounded window of decoded frames around a layer's playhead.
+// A prefetch thread keeps the next `capacity` frames (in playback order)
+// decoded; everything outside that window is evicted.
+typedef struct FrameRing FrameRing;
+
+// Create / destroy (starts and stops the prefetch thread)
+FrameRing* frame_ring_new(const DecoderManifest *manifest, int capacity, FrameFormat format);
+void frame_ring_free(FrameRing *ring);
+
+// Playback side
+void frame_ring_set_playhead(FrameRing *ring, int frame, double speed);
+// Copy a decoded frame into a streaming texture through `fx` (NULL = as is).
+// An SDL_PIXELFORMAT_IYUV texture takes YUV420 frames without FX.
+int frame_ring_upload(FrameRing *ring, int frame, SDL_Texture *texture, const FxChain *fx);
+
+// Info
+int frame_ring_get_frame_count(FrameRing *ring);
+int frame_ring_get_capacity(const FrameRing *ring);
+int frame_ring_get_ready_count(FrameRing *ring);
+void frame_ring_get_size(const FrameRing *ring, int *width, int *height);
+FrameFormat frame_ring_get_format(const FrameRing *ring);
+
+#endif // FRAME_RING_H
@@ -0,0 +1,297 @@
+/* Frame sinks: pack, PNG folder, FFmpeg pipe */
+#include "frame_sink.h"
+#include "frame_pack.h"
+
+#include <stdio.h>
+#include <glib/gstdio.h>
+#include <SDL2/SDL_image.h>
+
+// Frames waiting for the FFmpeg pipe (BGRA, ~8 MB each at 1080p)
+#define FFMPEG_QUEUE_FRAMES 8
+
+typedef enum {
+    FRAME_SINK_PACK,
+    FRAME_SINK_PNG,
+    FRAME_SINK_FFMPEG
+} FrameSinkType;
+
+struct FrameSink {
+    FrameSinkType    type;
+    int              width;
+    int              height;
+
+    // Pack
+    FramePackWriter *pack;
+    FrameCodec       codec;
+
+    // PNG folder
+    gchar           *folder;
+
+    // FFmpeg
+    gchar           *output;
+    FILE            *pipe;
+    GThread         *feeder;
+    GMutex           lock;
+    GCond            changed;   // queue grew, shrank or is closing
+    GQueue          *queue;     // GByteArray, frame order
+    gboolean         closing;
+    gboolean         failed;    // pipe broke, later frames are refused
+};
+
+FrameSink* frame_sink_pack_new(const char *path, FrameCodec codec, int width, int height, int fps)
+{
+    FramePackWriter *pack = frame_pack_create(path, codec, width, height, fps);
+    if (!pack) return NULL;
+
+    FrameSink *sink = g_new0(FrameSink, 1);
+    sink->type = FRAME_SINK_PACK;
+    sink->pack = pack;
+    sink->codec = codec;
+    sink->width = width;
+    sink->height = height;
+    return sink;
+}
+
+FrameSink* frame_sink_png_new(const char *folder)
+{
+    if (g_mkdir_with_parents(folder, 0755) != 0) {
+        g_printerr("[SINK] Cannot create %s\n", folder);
+        return NULL;
+    }
+
+    FrameSink *sink = g_new0(FrameSink, 1);
+    sink->type = FRAME_SINK_PNG;
+    sink->folder = g_strdup(folder);
+    return sink;
+}
+
+// Feeder thread: the only writer of the pipe
+static gpointer ffmpeg_feeder(gpointer data)
+{
+    FrameSink *sink = data;
+
+    g_mutex_lock(&sink->lock);
+    for (;;) {
+        while (g_queue_is_empty(sink->queue) && !sink->closing)
+            g_cond_wait(&sink->changed, &sink->lock);
+        if (g_queue_is_empty(sink->queue)) break;
+
+        GByteArray *frame = g_queue_pop_head(sink->queue);
+        gboolean failed = sink->failed;
+        g_cond_broadcast(&sink->changed);
+        g_mutex_unlock(&sink->lock);
+
+        gboolean ok = failed || fwrite(frame->data, 1, frame->len, sink->pipe) == frame->len;
+        g_byte_array_free(frame, TRUE);
+
+        g_mutex_lock(&sink->lock);
+        if (!ok && !sink->failed) {
+            g_printerr("[SINK] FFmpeg pipe closed early (%s)\n", sink->output);
+            sink->failed = TRUE;
+            g_cond_broadcast(&sink->changed);
+        }
+    }
+    g_mutex_unlock(&sink->lock);
+    return NULL;
+}
+
+FrameSink* frame_sink_ffmpeg_new(const char *output, int width, int height, int fps,
+                                 int out_width, int out_height)
+{
+    gchar *scale = out_width > 0 && out_height > 0 &&
+                   (out_width != width || out_height != height)
+                 ? g_strdup_printf("-vf scale=%d:%d ", out_width, out_height)
+                 : g_strdup("");
+    gchar *cmd = g_strdup_printf(
+        "ffmpeg -y -loglevel error -f rawvideo -pix_fmt bgra -s %dx%d -framerate %d -i - "
+        "%s-pix_fmt yuv420p -c:v libx264 \"%s\"",
+        width, height, fps, scale, output);
+    g_free(scale);
+
+    FILE *pipe = popen(cmd, "w");
+    g_free(cmd);
+    if (!pipe) {
+        g_printerr("[SINK] Cannot start FFmpeg for %s\n", output);
+        return NULL;
+    }
+
+    FrameSink *sink = g_new0(FrameSink, 1);
+    sink->type = FRAME_SINK_FFMPEG;
+    sink->width = width;
+    sink->height = height;
+    sink->output = g_strdup(output);
+    sink->pipe = pipe;
+    sink->queue = g_queue_new();
+    g_mutex_init(&sink->lock);
+    g_cond_init(&sink->changed);
+    sink->feeder = g_thread_new("ffmpeg-sink", ffmpeg_feeder, sink);
+    return sink;
+}
+
+const char* frame_sink_get_name(const FrameSink *sink)
+{
+    switch (sink->type) {
+        case FRAME_SINK_PACK:   return "pack";
+        case FRAME_SINK_PNG:    return "png";
+        case FRAME_SINK_FFMPEG: return "ffmpeg";
+    }
+    return "?";
+}
+
+// ARGB8888 rows without padding (B,G,R,A in memory)
+static GByteArray* pack_rows(SDL_Surface *frame)
+{
+    gsize row = (gsize)frame->w * 4;
+    GByteArray *out = g_byte_array_sized_new(row * frame->h);
+    for (int y = 0; y < frame->h; y++)
+        g_byte_array_append(out, (const guint8 *)frame->pixels + y * frame->pitch, row);
+    return out;
+}
+
+int frame_sink_encode(FrameSink *sink, int index, SDL_Surface *frame, GByteArray **payload)
+{
+    *payload = NULL;
+    if (!sink || !frame) return -1;
+
+    switch (sink->type) {
+        case FRAME_SINK_PACK: {
+            GByteArray *out = g_byte_array_new();
+            if (frame_codec_encode(sink->codec, frame, out) != 0) {
+                g_printerr("[SINK] Frame %d encode failed: %s\n", index + 1, SDL_GetError());
+                g_byte_array_free(out, TRUE);
+                return -1;
+            }
+            *payload = out;
+            return 0;
+        }
+
+        case FRAME_SINK_PNG: {
+            // Named by index, so workers may save in any order
+            gchar *name = g_strdup_printf("frame_%05d.png", index + 1);
+            gchar *path = g_build_filename(sink->folder, name, NULL);
+            int ret = IMG_SavePNG(frame, path);
+            g_free(name);
+            g_free(path);
+            return ret;
+        }
+
+        case FRAME_SINK_FFMPEG:
+            if (frame->w != sink->width || frame->h != sink->height ||
+                frame->format->format != SDL_PIXELFORMAT_ARGB8888) {
+                g_printerr("[SINK] Frame %d does not match the FFmpeg input\n", index + 1);
+                return -1;
+            }
+            *payload = pack_rows(frame);
+            return 0;
+    }
+    return -1;
+}
+
+int frame_sink_write(FrameSink *sink, int index, GByteArray *payload)
+{
+    (void)index;
+    int ret = 0;
+
+    switch (sink->type) {
+        case FRAME_SINK_PACK:
+            ret = payload ? frame_pack_append_encoded(sink->pack, payload->data, payload->len) : -1;
+            break;
+
+        case FRAME_SINK_PNG:
+            break;
+
+        case FRAME_SINK_FFMPEG:
+            if (!payload) return -1;
+
+            // Bounded: wait for the feeder instead of growing the queue
+            g_mutex_lock(&sink->lock);
+            while (g_queue_get_length(sink->queue) >= FFMPEG_QUEUE_FRAMES && !sink->failed)
+                g_cond_wait(&sink->changed, &sink->lock);
+            if (sink->failed) {
+                ret = -1;
+            } else {
+                g_queue_push_tail(sink->queue, payload);
+                payload = NULL;
+                g_cond_broadcast(&sink->changed);
+            }
+            g_mutex_unlock(&sink->lock);
+            break;
+    }
+
+    if (payload) g_byte_array_free(payload, TRUE);
+    return ret;
+}
+
+int frame_sink_put(FrameSink *sink, int index, SDL_Surface *frame)
+{
+    GByteArray *payload = NULL;
+    if (frame_sink_encode(sink, index, frame, &payload) != 0) return -1;
+    return frame_sink_write(sink, index, payload);
+}
+
+// Stop the feeder (dropping queued frames if `discard`) and wait for FFmpeg
+static int close_ffmpeg(FrameSink *sink, gboolean discard)
+{
+    g_mutex_lock(&sink->lock);
+    if (discard) sink->failed = TRUE;
+    sink->closing = TRUE;
+    g_cond_broadcast(&sink->changed);
+    g_mutex_unlock(&sink->lock);
+
+    g_thread_join(sink->feeder);
+    gboolean failed = sink->failed;
+    int status = pclose(sink->pipe);
+
+    g_queue_free(sink->queue);
+    g_mutex_clear(&sink->lock);
+    g_cond_clear(&sink->changed);
+    return failed || status != 0 ? -1 : 0;
+}
+
+static void sink_free(FrameSink *sink)
+{
+    g_free(sink->folder);
+    g_free(sink->output);
+    g_free(sink);
+}
+
+int frame_sink_finish(FrameSink *sink)
+{
+    if (!sink) return -1;
+
+    int ret = 0;
+    switch (sink->type) {
+        case FRAME_SINK_PACK:
+            ret = frame_pack_finish(sink->pack);
+            break;
+        case FRAME_SINK_PNG:
+            break;
+        case FRAME_SINK_FFMPEG:
+            ret = close_ffmpeg(sink, FALSE);
+            if (ret != 0) g_printerr("[SINK] FFmpeg failed on %s\n", sink->output);
+            break;
+    }
+
+    sink_free(sink);
+    return ret;
+}
+
+void frame_sink_abort(FrameSink *sink)
+{
+    if (!sink) return;
+
+    switch (sink->type) {
+        case FRAME_SINK_PACK:
+            frame_pack_abort(sink->pack);
+            break;
+        case FRAME_SINK_PNG:
+            // Frames already saved stay; the caller owns the folder
+            break;
+        case FRAME_SINK_FFMPEG:
+            close_ffmpeg(sink, TRUE);
+            g_remove(sink->output);
+            break;
+    }
+
+    sink_free(sink);
+}
@@ -0,0 +1,43 @@
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+#include "frame_codec.h"
+
+// Destination of composited frames. A frame goes through two steps:
+// `encode` may run on any thread (bake workers encode in parallel) and
+// turns the frame into a payload; `write` takes the payloads in frame
+// order. Backends: frame pack, PNG folder, FFmpeg pipe.
+typedef struct FrameSink FrameSink;
+
+// Sequence pack (the format played back by the app)
+FrameSink* frame_sink_pack_new(const char *path, FrameCodec codec, int width, int height, int fps);
+
+// One frame_%05d.png per frame in `folder` (written by `encode`)
+FrameSink* frame_sink_png_new(const char *folder);
+
+// Raw BGRA frames piped into an FFmpeg H.264 encoder. A feeder thread
+// drains a bounded queue, so a slow encoder holds back `write` instead
+// of piling up frames. Output is scaled to `out_width` x `out_height`
+// (0 = source size).
+FrameSink* frame_sink_ffmpeg_new(const char *output, int width, int height, int fps,
+                                 int out_width, int out_height);
+
+const char* frame_sink_get_name(const FrameSink *sink);
+
+// Any thread. `payload` is set to NULL when the backend has nothing to
+// write in order.
+int frame_sink_encode(FrameSink *sink, int index, SDL_Surface *frame, GByteArray **payload);
+
+// Frame order; takes ownership of `payload` (may be NULL)
+int frame_sink_write(FrameSink *sink, int index, GByteArray *payload);
+
+// Encode and write, for serial producers
+int frame_sink_put(FrameSink *sink, int index, SDL_Surface *frame);
+
+// Both free the sink. Abort drops a partial output.
+int frame_sink_finish(FrameSink *sink);
+void frame_sink_abort(FrameSink *sink);
+
+#endif // FRAME_SINK_H
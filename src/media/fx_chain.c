@@ -0,0 +1,107 @@
+/* Fused per-layer FX (lookup tables) */
+#include "fx_chain.h"
+
+#include <string.h>
+
+#define ALPHA_MASK 0xFF000000u
+
+// Same fixed-point math as the pixel_fx kernels, so both paths agree
+static Uint8 contrast_value(int c, int k)
+{
+    int v = (((c - 128) * 128 * k) >> 16) + 128;
+    return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static inline Uint32 gray_value(Uint32 p)
+{
+    Uint32 sum = ((p >> 16) & 0xFF) + ((p >> 8) & 0xFF) + (p & 0xFF);
+    return (sum * 21846) >> 16;
+}
+
+void fx_chain_compile(FxChain *chain, const FxParams *params)
+{
+    int k = (int)(CLAMP(params->contrast, 0.0, 8.0) * 512 + 0.5);
+    gboolean contrast = k != 512;
+    int threshold = CLAMP(params->threshold, 0, 255);
+
+    chain->luma = params->grayscale || threshold > 0;
+    chain->identity = !chain->luma && !params->invert && !contrast;
+
+    for (int v = 0; v < 256; v++) {
+        int out = contrast ? contrast_value(v, k) : v;
+        if (threshold > 0) out = out >= threshold ? 255 : 0;
+        if (params->invert) out = 255 - out;
+        chain->lut[0][v] = chain->lut[1][v] = chain->lut[2][v] = (Uint8)out;
+    }
+
+    // Single-step chains run on the SIMD kernels instead of the tables
+    int steps = (params->grayscale && threshold == 0) + (threshold > 0) + params->invert + contrast;
+    chain->kernel = PIXEL_FX_OP_COUNT;
+    chain->kernel_param = 0;
+    if (steps == 1) {
+        if (params->grayscale && threshold == 0) {
+            chain->kernel = PIXEL_FX_GRAYSCALE;
+        } else if (threshold > 0) {
+            chain->kernel = PIXEL_FX_THRESHOLD;
+            chain->kernel_param = threshold;
+        } else if (params->invert) {
+            chain->kernel = PIXEL_FX_INVERT;
+        } else {
+            chain->kernel = PIXEL_FX_CONTRAST;
+            chain->kernel_param = params->contrast;
+        }
+    }
+}
+
+void fx_chain_apply_row(const FxChain *chain, const Uint32 *src, Uint32 *dst, int n)
+{
+    if (chain->identity) {
+        if (dst != src) memcpy(dst, src, sizeof(Uint32) * n);
+        return;
+    }
+
+    if (chain->kernel != PIXEL_FX_OP_COUNT) {
+        pixel_fx_row(chain->kernel, src, dst, n, chain->kernel_param);
+        return;
+    }
+
+    const Uint8 *r = chain->lut[0], *g = chain->lut[1], *b = chain->lut[2];
+    if (chain->luma) {
+        for (int i = 0; i < n; i++) {
+            Uint32 p = src[i];
+            Uint32 v = r[gray_value(p)];
+            dst[i] = (p & ALPHA_MASK) | (v << 16) | (v << 8) | v;
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            Uint32 p = src[i];
+            dst[i] = (p & ALPHA_MASK)
+                   | ((Uint32)r[(p >> 16) & 0xFF] << 16)
+                   | ((Uint32)g[(p >> 8) & 0xFF] << 8)
+                   | b[p & 0xFF];
+        }
+    }
+}
+
+int fx_chain_apply_surface(const FxChain *chain, SDL_Surface *src, SDL_Surface *dst)
+{
+    if (!src || !dst || src->w != dst->w || src->h != dst->h ||
+        src->format->format != SDL_PIXELFORMAT_ARGB8888 ||
+        dst->format->format != SDL_PIXELFORMAT_ARGB8888)
+        return -1;
+
+    if (chain->identity && src == dst) return 0;
+
+    SDL_LockSurface(src);
+    if (dst != src) SDL_LockSurface(dst);
+
+    for (int y = 0; y < src->h; y++) {
+        const Uint32 *in = (const Uint32 *)((const Uint8 *)src->pixels + y * src->pitch);
+        Uint32 *out = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+        fx_chain_apply_row(chain, in, out, src->w);
+    }
+
+    if (dst != src) SDL_UnlockSurface(dst);
+    SDL_UnlockSurface(src);
+    return 0;
+}
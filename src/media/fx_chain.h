@@ -0,0 +1,36 @@
+#ifndef FX_CHAIN_H
+#define FX_CHAIN_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+#include "pixel_fx.h"
+
+// Point-operation settings of a layer (alpha and speed are applied at draw)
+typedef struct {
+    gboolean grayscale;
+    gboolean invert;
+    double   contrast;      // 1.0 = off
+    int      threshold;     // 0 = off, else gray >= threshold -> white
+} FxParams;
+
+// FX settings folded into lookup tables and run in one pass per pixel.
+// Order: contrast, threshold, invert. Gray and threshold go through the
+// luma path: channels are averaged first, then lut[0] maps the gray value.
+typedef struct {
+    Uint8     lut[3][256];  // R, G, B
+    gboolean  luma;
+    gboolean  identity;
+    PixelFxOp kernel;       // chain is exactly one SIMD kernel (else PIXEL_FX_OP_COUNT)
+    double    kernel_param;
+} FxChain;
+
+#define FX_PARAMS_NONE { FALSE, FALSE, 1.0, 0 }
+
+// Rebuild the tables (a few microseconds)
+void fx_chain_compile(FxChain *chain, const FxParams *params);
+
+// ARGB8888, src == dst is allowed
+void fx_chain_apply_row(const FxChain *chain, const Uint32 *src, Uint32 *dst, int n);
+int fx_chain_apply_surface(const FxChain *chain, SDL_Surface *src, SDL_Surface *dst);
+
+#endif // FX_CHAIN_H
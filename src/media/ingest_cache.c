@@ -0,0 +1,225 @@
+/* Persistent ingest cache */
+#include "ingest_cache.h"
+#include "decoder.h"
+#include "../utils/utils.h"
+
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#define KEY_SAMPLE_BYTES (1024 * 1024)
+
+typedef struct {
+    gchar *path;
+    gint64 mtime;
+    gint64 bytes;
+} CacheEntry;
+
+static GMutex cache_lock;
+
+static gchar* cache_root(void)
+{
+    return g_build_filename(g_get_user_cache_dir(), INGEST_CACHE_DIR, NULL);
+}
+
+static gint64 cache_max_bytes(void)
+{
+    const char *env = g_getenv("PULSRR_CACHE_MAX_MB");
+    if (env && atoi(env) > 0) return (gint64)atoi(env) * 1024 * 1024;
+    return INGEST_CACHE_MAX_BYTES;
+}
+
+static void hash_sample(GChecksum *sum, FILE *f, long offset, guchar *buf)
+{
+    if (fseek(f, offset, SEEK_SET) != 0) return;
+    size_t n = fread(buf, 1, KEY_SAMPLE_BYTES, f);
+    g_checksum_update(sum, buf, n);
+}
+
+gchar* ingest_cache_key(const char *source, int fps, int width)
+{
+    struct stat st;
+    if (!source || stat(source, &st) != 0 || !S_ISREG(st.st_mode)) return NULL;
+
+    FILE *f = fopen(source, "rb");
+    if (!f) return NULL;
+
+    GChecksum *sum = g_checksum_new(G_CHECKSUM_SHA256);
+    guchar *buf = g_malloc(KEY_SAMPLE_BYTES);
+
+    gchar *params = g_strdup_printf("%lld:%d:%d", (long long)st.st_size, fps, width);
+    g_checksum_update(sum, (const guchar *)params, -1);
+    g_free(params);
+
+    hash_sample(sum, f, 0, buf);
+    if (st.st_size > KEY_SAMPLE_BYTES)
+        hash_sample(sum, f, (long)(st.st_size - KEY_SAMPLE_BYTES), buf);
+
+    gchar *key = g_strdup(g_checksum_get_string(sum));
+
+    g_free(buf);
+    g_checksum_free(sum);
+    fclose(f);
+    return key;
+}
+
+// Hard link when the cache shares the filesystem, copy otherwise
+static int link_or_copy(const char *src, const char *dst)
+{
+    g_unlink(dst);
+    if (link(src, dst) == 0) return 0;
+    return copy_file(src, dst);
+}
+
+gboolean ingest_cache_restore(const char *key, const char *source, const char *folder)
+{
+    if (!key || !source || !folder) return FALSE;
+
+    gchar *root = cache_root();
+    gchar *entry = g_build_filename(root, key, NULL);
+    g_free(root);
+
+    g_mutex_lock(&cache_lock);
+
+    DecoderManifest manifest;
+    gboolean hit = decoder_read_manifest(entry, &manifest) == 0;
+    if (hit) {
+        gchar *src = g_build_filename(entry, DECODER_PREVIEW_NAME, NULL);
+        gchar *dst = g_build_filename(folder, DECODER_PREVIEW_NAME, NULL);
+        if (g_file_test(src, G_FILE_TEST_EXISTS))
+            link_or_copy(src, dst);
+        g_free(src);
+        g_free(dst);
+
+        // Same content may live at another path now
+        g_free(manifest.source);
+        manifest.source = g_strdup(source);
+        hit = decoder_write_manifest(folder, &manifest) == 0;
+        decoder_free_manifest(&manifest);
+
+        // Directory mtime is the LRU clock
+        utime(entry, NULL);
+    }
+
+    g_mutex_unlock(&cache_lock);
+    g_free(entry);
+    return hit;
+}
+
+static gint64 entry_bytes(const char *path)
+{
+    gint64 bytes = 0;
+    GDir *dir = g_dir_open(path, 0, NULL);
+    if (!dir) return 0;
+
+    const gchar *name;
+    while ((name = g_dir_read_name(dir))) {
+        gchar *file = g_build_filename(path, name, NULL);
+        struct stat st;
+        if (stat(file, &st) == 0) bytes += st.st_size;
+        g_free(file);
+    }
+    g_dir_close(dir);
+    return bytes;
+}
+
+static void remove_entry(const char *path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    if (dir) {
+        const gchar *name;
+        while ((name = g_dir_read_name(dir))) {
+            gchar *file = g_build_filename(path, name, NULL);
+            g_unlink(file);
+            g_free(file);
+        }
+        g_dir_close(dir);
+    }
+    g_rmdir(path);
+}
+
+static gint compare_entry_age(gconstpointer a, gconstpointer b)
+{
+    const CacheEntry *ea = *(CacheEntry * const *)a;
+    const CacheEntry *eb = *(CacheEntry * const *)b;
+    return (ea->mtime > eb->mtime) - (ea->mtime < eb->mtime);
+}
+
+static void free_entry(gpointer data)
+{
+    CacheEntry *e = data;
+    g_free(e->path);
+    g_free(e);
+}
+
+// Evict least recently used entries until the cache fits its cap
+static void cache_trim(const char *root)
+{
+    GDir *dir = g_dir_open(root, 0, NULL);
+    if (!dir) return;
+
+    GPtrArray *entries = g_ptr_array_new_with_free_func(free_entry);
+    gint64 total = 0;
+
+    const gchar *name;
+    while ((name = g_dir_read_name(dir))) {
+        gchar *path = g_build_filename(root, name, NULL);
+        struct stat st;
+        if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+            g_free(path);
+            continue;
+        }
+
+        CacheEntry *e = g_new0(CacheEntry, 1);
+        e->path = path;
+        e->mtime = st.st_mtime;
+        e->bytes = entry_bytes(path);
+        total += e->bytes;
+        g_ptr_array_add(entries, e);
+    }
+    g_dir_close(dir);
+
+    gint64 cap = cache_max_bytes();
+    g_ptr_array_sort(entries, compare_entry_age);
+    for (guint i = 0; i < entries->len && total > cap; i++) {
+        CacheEntry *e = g_ptr_array_index(entries, i);
+        remove_entry(e->path);
+        total -= e->bytes;
+        g_print("[CACHE] Evicted %s\n", e->path);
+    }
+
+    g_ptr_array_free(entries, TRUE);
+}
+
+void ingest_cache_store(const char *key, const char *folder)
+{
+    if (!key || !folder) return;
+
+    gchar *root = cache_root();
+    gchar *entry = g_build_filename(root, key, NULL);
+
+    g_mutex_lock(&cache_lock);
+
+    if (g_mkdir_with_parents(entry, 0755) != 0) {
+        g_printerr("[CACHE] Cannot create %s\n", entry);
+    } else {
+        // Manifest last: an entry without one is never a hit
+        const char *files[] = { DECODER_PREVIEW_NAME, DECODER_MANIFEST_NAME };
+        for (guint i = 0; i < G_N_ELEMENTS(files); i++) {
+            gchar *src = g_build_filename(folder, files[i], NULL);
+            gchar *dst = g_build_filename(entry, files[i], NULL);
+            if (g_file_test(src, G_FILE_TEST_EXISTS) && copy_file(src, dst) != 0)
+                g_printerr("[CACHE] Cannot store %s\n", dst);
+            g_free(src);
+            g_free(dst);
+        }
+        cache_trim(root);
+    }
+
+    g_mutex_unlock(&cache_lock);
+    g_free(entry);
+    g_free(root);
+}
@@ -0,0 +1,23 @@
+#ifndef INGEST_CACHE_H
+#define INGEST_CACHE_H
+
+#include <glib.h>
+
+// Ingest results (manifest + preview) kept across sessions under
+// $XDG_CACHE_HOME/pulsrr/<key>, least recently used entries evicted first
+#define INGEST_CACHE_DIR       "pulsrr"
+#define INGEST_CACHE_MAX_BYTES (64 * 1024 * 1024)   // override: PULSRR_CACHE_MAX_MB
+
+// Key of a clip ingested at `fps` / `width`: hash of its size and of its
+// first and last megabyte, so renamed or copied files still hit.
+// Returns NULL when the file cannot be read.
+gchar* ingest_cache_key(const char *source, int fps, int width);
+
+// Fill `folder` from a cached entry. The manifest is rewritten to point
+// at `source`. Returns TRUE on a hit.
+gboolean ingest_cache_restore(const char *key, const char *source, const char *folder);
+
+// Store the ingest result of `folder`, then trim the cache to its cap
+void ingest_cache_store(const char *key, const char *folder);
+
+#endif // INGEST_CACHE_H
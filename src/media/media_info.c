@@ -0,0 +1,158 @@
+/* Cached media probing (libavformat) */
+#include "media_info.h"
+
+#include <libavformat/avformat.h>
+#include <sys/stat.h>
+#include <string.h>
+
+typedef struct {
+    gint64    mtime;
+    gint64    size;
+    MediaInfo info;
+} CacheEntry;
+
+typedef struct {
+    gchar         *path;
+    MediaInfo      info;
+    MediaInfoReady ready;
+    gpointer       user_data;
+} ProbeJob;
+
+static GMutex      cache_lock;
+static GHashTable *cache = NULL;   // path -> CacheEntry*
+
+static gboolean stat_file(const char *path, gint64 *mtime, gint64 *size)
+{
+    struct stat st;
+    if (!path || stat(path, &st) != 0 || !S_ISREG(st.st_mode)) return FALSE;
+    *mtime = (gint64)st.st_mtim.tv_sec * G_USEC_PER_SEC + st.st_mtim.tv_nsec / 1000;
+    *size = st.st_size;
+    return TRUE;
+}
+
+static gboolean probe_file(const char *path, gint64 size, MediaInfo *info)
+{
+    memset(info, 0, sizeof(*info));
+    info->file_size = size;
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    AVFormatContext *fmt = NULL;
+    if (avformat_open_input(&fmt, path, NULL, NULL) < 0) {
+        g_printerr("[PROBE] Cannot open %s\n", path);
+        return FALSE;
+    }
+
+    if (avformat_find_stream_info(fmt, NULL) < 0) {
+        g_printerr("[PROBE] No stream info in %s\n", path);
+        avformat_close_input(&fmt);
+        return FALSE;
+    }
+
+    int idx = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if (idx >= 0) {
+        AVStream *st = fmt->streams[idx];
+        info->width = st->codecpar->width;
+        info->height = st->codecpar->height;
+        if (st->r_frame_rate.den > 0)
+            info->fps = av_q2d(st->r_frame_rate);
+
+        if (fmt->duration != AV_NOPTS_VALUE)
+            info->duration = fmt->duration / (double)AV_TIME_BASE;
+        else if (st->duration != AV_NOPTS_VALUE)
+            info->duration = st->duration * av_q2d(st->time_base);
+
+        info->valid = TRUE;
+    } else {
+        g_printerr("[PROBE] No video stream in %s\n", path);
+    }
+
+    avformat_close_input(&fmt);
+    return info->valid;
+}
+
+static gboolean cache_find(const char *path, gint64 mtime, gint64 size, MediaInfo *info)
+{
+    gboolean hit = FALSE;
+
+    g_mutex_lock(&cache_lock);
+    CacheEntry *e = cache ? g_hash_table_lookup(cache, path) : NULL;
+    if (e && e->mtime == mtime && e->size == size) {
+        *info = e->info;
+        hit = TRUE;
+    }
+    g_mutex_unlock(&cache_lock);
+
+    return hit;
+}
+
+static void cache_store(const char *path, gint64 mtime, gint64 size, const MediaInfo *info)
+{
+    CacheEntry *e = g_new0(CacheEntry, 1);
+    e->mtime = mtime;
+    e->size = size;
+    e->info = *info;
+
+    g_mutex_lock(&cache_lock);
+    if (!cache)
+        cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    g_hash_table_replace(cache, g_strdup(path), e);
+    g_mutex_unlock(&cache_lock);
+}
+
+// Cached probe
+gboolean media_info_get(const char *path, MediaInfo *info)
+{
+    gint64 mtime, size;
+    memset(info, 0, sizeof(*info));
+    if (!stat_file(path, &mtime, &size)) return FALSE;
+
+    if (cache_find(path, mtime, size, info)) return info->valid;
+
+    // Failed probes are cached too, so a bad file is not reopened on every call
+    probe_file(path, size, info);
+    cache_store(path, mtime, size, info);
+    return info->valid;
+}
+
+gboolean media_info_lookup(const char *path, MediaInfo *info)
+{
+    gint64 mtime, size;
+    memset(info, 0, sizeof(*info));
+    if (!stat_file(path, &mtime, &size)) return FALSE;
+    return cache_find(path, mtime, size, info) && info->valid;
+}
+
+// Async probe
+static gboolean probe_ready_cb(gpointer data)
+{
+    ProbeJob *job = data;
+    job->ready(job->path, &job->info, job->user_data);
+    g_free(job->path);
+    g_free(job);
+    return G_SOURCE_REMOVE;
+}
+
+static gpointer probe_thread(gpointer data)
+{
+    ProbeJob *job = data;
+    media_info_get(job->path, &job->info);
+    g_idle_add(probe_ready_cb, job);
+    return NULL;
+}
+
+void media_info_probe_async(const char *path, MediaInfoReady ready, gpointer user_data)
+{
+    ProbeJob *job = g_new0(ProbeJob, 1);
+    job->path = g_strdup(path);
+    job->ready = ready;
+    job->user_data = user_data;
+
+    // Cache hits skip the thread but are still delivered from the main loop
+    if (media_info_lookup(path, &job->info)) {
+        g_idle_add(probe_ready_cb, job);
+        return;
+    }
+
+    g_thread_unref(g_thread_new("media-probe", probe_thread, job));
+}
@@ -0,0 +1,28 @@
+#ifndef MEDIA_INFO_H
+#define MEDIA_INFO_H
+
+#include <glib.h>
+
+// Stream properties of a video file, probed once with libavformat
+typedef struct {
+    gboolean valid;
+    int      width;
+    int      height;
+    double   fps;           // r_frame_rate of the video stream
+    double   duration;      // seconds
+    gint64   file_size;     // bytes
+} MediaInfo;
+
+typedef void (*MediaInfoReady)(const char *path, const MediaInfo *info, gpointer user_data);
+
+// Cached probe (keyed by path, invalidated when mtime or size change).
+// Probes synchronously on a cache miss.
+gboolean media_info_get(const char *path, MediaInfo *info);
+
+// Cache only, never probes
+gboolean media_info_lookup(const char *path, MediaInfo *info);
+
+// Probe on a worker thread; `ready` runs on the main loop
+void media_info_probe_async(const char *path, MediaInfoReady ready, gpointer user_data);
+
+#endif // MEDIA_INFO_H
@@ -0,0 +1,436 @@
+/* Pixel FX kernels (scalar / SSE2 / AVX2, runtime dispatch) */
+#include "pixel_fx.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PIXEL_FX_X86 1
+#include <immintrin.h>
+#endif
+
+#define ALPHA_MASK 0xFF000000u
+#define RGB_MASK   0x00FFFFFFu
+#define DIV3_MUL   21846    // (x * DIV3_MUL) >> 16 == x / 3 for x <= 765
+
+// Kernel parameters are pre-converted to integers so all paths agree:
+// contrast = factor * 512, threshold = level, alpha = 0..255
+typedef void (*RowKernel)(const Uint32 *src, Uint32 *dst, int n, int param);
+
+typedef struct {
+    RowKernel ops[PIXEL_FX_OP_COUNT];
+} KernelSet;
+
+// Scalar
+static inline Uint32 gray_value(Uint32 p)
+{
+    Uint32 sum = ((p >> 16) & 0xFF) + ((p >> 8) & 0xFF) + (p & 0xFF);
+    return (sum * DIV3_MUL) >> 16;
+}
+
+static inline Uint32 contrast_channel(Uint32 c, int k)
+{
+    int v = ((((int)c - 128) * 128 * k) >> 16) + 128;
+    return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static void gray_scalar(const Uint32 *src, Uint32 *dst, int n, int param)
+{
+    (void)param;
+    for (int i = 0; i < n; i++) {
+        Uint32 v = gray_value(src[i]);
+        dst[i] = (src[i] & ALPHA_MASK) | (v << 16) | (v << 8) | v;
+    }
+}
+
+static void invert_scalar(const Uint32 *src, Uint32 *dst, int n, int param)
+{
+    (void)param;
+    for (int i = 0; i < n; i++)
+        dst[i] = src[i] ^ RGB_MASK;
+}
+
+static void contrast_scalar(const Uint32 *src, Uint32 *dst, int n, int k)
+{
+    for (int i = 0; i < n; i++) {
+        Uint32 p = src[i];
+        dst[i] = (p & ALPHA_MASK)
+               | (contrast_channel((p >> 16) & 0xFF, k) << 16)
+               | (contrast_channel((p >> 8) & 0xFF, k) << 8)
+               | contrast_channel(p & 0xFF, k);
+    }
+}
+
+static void threshold_scalar(const Uint32 *src, Uint32 *dst, int n, int level)
+{
+    for (int i = 0; i < n; i++)
+        dst[i] = (src[i] & ALPHA_MASK) | ((int)gray_value(src[i]) >= level ? RGB_MASK : 0);
+}
+
+static void alpha_scalar(const Uint32 *src, Uint32 *dst, int n, int alpha)
+{
+    for (int i = 0; i < n; i++) {
+        Uint32 t = (src[i] >> 24) * alpha + 128;
+        dst[i] = (src[i] & RGB_MASK) | (((t + (t >> 8)) >> 8) << 24);
+    }
+}
+
+static const KernelSet kernels_scalar = {{
+    gray_scalar, invert_scalar, contrast_scalar, threshold_scalar, alpha_scalar
+}};
+
+#ifdef PIXEL_FX_X86
+
+// SSE2: 4 pixels per step, the tail goes through the scalar kernel
+__attribute__((target("sse2")))
+static inline __m128i gray_sse2(__m128i p)
+{
+    const __m128i lo = _mm_set1_epi32(0xFF);
+    __m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_and_si128(p, lo),
+                                              _mm_and_si128(_mm_srli_epi32(p, 8), lo)),
+                                _mm_and_si128(_mm_srli_epi32(p, 16), lo));
+    return _mm_mulhi_epu16(sum, _mm_set1_epi32(DIV3_MUL));
+}
+
+__attribute__((target("sse2")))
+static void gray_sse2_row(const Uint32 *src, Uint32 *dst, int n, int param)
+{
+    const __m128i amask = _mm_set1_epi32(ALPHA_MASK);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i v = gray_sse2(p);
+        v = _mm_or_si128(_mm_or_si128(v, _mm_slli_epi32(v, 8)), _mm_slli_epi32(v, 16));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(v, _mm_and_si128(p, amask)));
+    }
+    gray_scalar(src + i, dst + i, n - i, param);
+}
+
+__attribute__((target("sse2")))
+static void invert_sse2_row(const Uint32 *src, Uint32 *dst, int n, int param)
+{
+    const __m128i rgb = _mm_set1_epi32(RGB_MASK);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(p, rgb));
+    }
+    invert_scalar(src + i, dst + i, n - i, param);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i contrast_sse2_half(__m128i c16, __m128i k)
+{
+    const __m128i mid = _mm_set1_epi16(128);
+    __m128i d = _mm_slli_epi16(_mm_sub_epi16(c16, mid), 7);
+    return _mm_add_epi16(_mm_mulhi_epi16(d, k), mid);
+}
+
+__attribute__((target("sse2")))
+static void contrast_sse2_row(const Uint32 *src, Uint32 *dst, int n, int k)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i kv = _mm_set1_epi16((short)k);
+    const __m128i amask = _mm_set1_epi32(ALPHA_MASK);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = contrast_sse2_half(_mm_unpacklo_epi8(p, zero), kv);
+        __m128i hi = contrast_sse2_half(_mm_unpackhi_epi8(p, zero), kv);
+        __m128i out = _mm_packus_epi16(lo, hi);
+        out = _mm_or_si128(_mm_andnot_si128(amask, out), _mm_and_si128(p, amask));
+        _mm_storeu_si128((__m128i *)(dst + i), out);
+    }
+    contrast_scalar(src + i, dst + i, n - i, k);
+}
+
+__attribute__((target("sse2")))
+static void threshold_sse2_row(const Uint32 *src, Uint32 *dst, int n, int level)
+{
+    const __m128i amask = _mm_set1_epi32(ALPHA_MASK);
+    const __m128i rgb = _mm_set1_epi32(RGB_MASK);
+    const __m128i below = _mm_set1_epi32(level - 1);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i on = _mm_cmpgt_epi32(gray_sse2(p), below);
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_or_si128(_mm_and_si128(on, rgb), _mm_and_si128(p, amask)));
+    }
+    threshold_scalar(src + i, dst + i, n - i, level);
+}
+
+__attribute__((target("sse2")))
+static void alpha_sse2_row(const Uint32 *src, Uint32 *dst, int n, int alpha)
+{
+    const __m128i rgb = _mm_set1_epi32(RGB_MASK);
+    const __m128i av = _mm_set1_epi32(alpha);
+    const __m128i round = _mm_set1_epi32(128);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i t = _mm_add_epi32(_mm_mullo_epi16(_mm_srli_epi32(p, 24), av), round);
+        __m128i a = _mm_srli_epi32(_mm_add_epi32(t, _mm_srli_epi32(t, 8)), 8);
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_or_si128(_mm_and_si128(p, rgb), _mm_slli_epi32(a, 24)));
+    }
+    alpha_scalar(src + i, dst + i, n - i, alpha);
+}
+
+static const KernelSet kernels_sse2 = {{
+    gray_sse2_row, invert_sse2_row, contrast_sse2_row, threshold_sse2_row, alpha_sse2_row
+}};
+
+// AVX2: same arithmetic on 8 pixels per step
+__attribute__((target("avx2")))
+static inline __m256i gray_avx2(__m256i p)
+{
+    const __m256i lo = _mm256_set1_epi32(0xFF);
+    __m256i sum = _mm256_add_epi32(_mm256_add_epi32(_mm256_and_si256(p, lo),
+                                                    _mm256_and_si256(_mm256_srli_epi32(p, 8), lo)),
+                                   _mm256_and_si256(_mm256_srli_epi32(p, 16), lo));
+    return _mm256_mulhi_epu16(sum, _mm256_set1_epi32(DIV3_MUL));
+}
+
+__attribute__((target("avx2")))
+static void gray_avx2_row(const Uint32 *src, Uint32 *dst, int n, int param)
+{
+    const __m256i amask = _mm256_set1_epi32(ALPHA_MASK);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i v = gray_avx2(p);
+        v = _mm256_or_si256(_mm256_or_si256(v, _mm256_slli_epi32(v, 8)), _mm256_slli_epi32(v, 16));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_or_si256(v, _mm256_and_si256(p, amask)));
+    }
+    gray_scalar(src + i, dst + i, n - i, param);
+}
+
+__attribute__((target("avx2")))
+static void invert_avx2_row(const Uint32 *src, Uint32 *dst, int n, int param)
+{
+    const __m256i rgb = _mm256_set1_epi32(RGB_MASK);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(p, rgb));
+    }
+    invert_scalar(src + i, dst + i, n - i, param);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i contrast_avx2_half(__m256i c16, __m256i k)
+{
+    const __m256i mid = _mm256_set1_epi16(128);
+    __m256i d = _mm256_slli_epi16(_mm256_sub_epi16(c16, mid), 7);
+    return _mm256_add_epi16(_mm256_mulhi_epi16(d, k), mid);
+}
+
+__attribute__((target("avx2")))
+static void contrast_avx2_row(const Uint32 *src, Uint32 *dst, int n, int k)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i kv = _mm256_set1_epi16((short)k);
+    const __m256i amask = _mm256_set1_epi32(ALPHA_MASK);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(src + i));
+        // unpack / pack both work per 128-bit lane, so pixel order is kept
+        __m256i lo = contrast_avx2_half(_mm256_unpacklo_epi8(p, zero), kv);
+        __m256i hi = contrast_avx2_half(_mm256_unpackhi_epi8(p, zero), kv);
+        __m256i out = _mm256_packus_epi16(lo, hi);
+        out = _mm256_or_si256(_mm256_andnot_si256(amask, out), _mm256_and_si256(p, amask));
+        _mm256_storeu_si256((__m256i *)(dst + i), out);
+    }
+    contrast_scalar(src + i, dst + i, n - i, k);
+}
+
+__attribute__((target("avx2")))
+static void threshold_avx2_row(const Uint32 *src, Uint32 *dst, int n, int level)
+{
+    const __m256i amask = _mm256_set1_epi32(ALPHA_MASK);
+    const __m256i rgb = _mm256_set1_epi32(RGB_MASK);
+    const __m256i below = _mm256_set1_epi32(level - 1);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i on = _mm256_cmpgt_epi32(gray_avx2(p), below);
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            _mm256_or_si256(_mm256_and_si256(on, rgb), _mm256_and_si256(p, amask)));
+    }
+    threshold_scalar(src + i, dst + i, n - i, level);
+}
+
+__attribute__((target("avx2")))
+static void alpha_avx2_row(const Uint32 *src, Uint32 *dst, int n, int alpha)
+{
+    const __m256i rgb = _mm256_set1_epi32(RGB_MASK);
+    const __m256i av = _mm256_set1_epi32(alpha);
+    const __m256i round = _mm256_set1_epi32(128);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i t = _mm256_add_epi32(_mm256_mullo_epi16(_mm256_srli_epi32(p, 24), av), round);
+        __m256i a = _mm256_srli_epi32(_mm256_add_epi32(t, _mm256_srli_epi32(t, 8)), 8);
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            _mm256_or_si256(_mm256_and_si256(p, rgb), _mm256_slli_epi32(a, 24)));
+    }
+    alpha_scalar(src + i, dst + i, n - i, alpha);
+}
+
+static const KernelSet kernels_avx2 = {{
+    gray_avx2_row, invert_avx2_row, contrast_avx2_row, threshold_avx2_row, alpha_avx2_row
+}};
+
+#endif // PIXEL_FX_X86
+
+// Dispatch
+static gboolean path_supported(PixelFxPath path)
+{
+    switch (path) {
+    case PIXEL_FX_PATH_SCALAR: return TRUE;
+#ifdef PIXEL_FX_X86
+    case PIXEL_FX_PATH_SSE2:   return __builtin_cpu_supports("sse2");
+    case PIXEL_FX_PATH_AVX2:   return __builtin_cpu_supports("avx2");
+#endif
+    default:                   return FALSE;
+    }
+}
+
+static const KernelSet* path_kernels(PixelFxPath path)
+{
+#ifdef PIXEL_FX_X86
+    if (path == PIXEL_FX_PATH_AVX2) return &kernels_avx2;
+    if (path == PIXEL_FX_PATH_SSE2) return &kernels_sse2;
+#endif
+    return &kernels_scalar;
+}
+
+static PixelFxPath select_path(void)
+{
+    const char *env = g_getenv("PULSRR_PIXEL_FX");
+    for (int p = 0; env && p < PIXEL_FX_PATH_COUNT; p++) {
+        if (g_ascii_strcasecmp(env, pixel_fx_get_path_name(p)) != 0) continue;
+        if (path_supported(p)) return p;
+        g_printerr("[FX] %s not supported on this CPU\n", env);
+    }
+
+    for (int p = PIXEL_FX_PATH_COUNT - 1; p > PIXEL_FX_PATH_SCALAR; p--)
+        if (path_supported(p)) return p;
+    return PIXEL_FX_PATH_SCALAR;
+}
+
+PixelFxPath pixel_fx_get_path(void)
+{
+    static gsize path = 0;   // PixelFxPath + 1, 0 until selected
+    if (g_once_init_enter(&path)) {
+#ifdef PIXEL_FX_X86
+        __builtin_cpu_init();
+#endif
+        PixelFxPath selected = select_path();
+        g_print("[FX] Pixel kernels: %s\n", pixel_fx_get_path_name(selected));
+        g_once_init_leave(&path, selected + 1);
+    }
+    return (PixelFxPath)(path - 1);
+}
+
+const char* pixel_fx_get_path_name(PixelFxPath path)
+{
+    switch (path) {
+    case PIXEL_FX_PATH_SCALAR: return "scalar";
+    case PIXEL_FX_PATH_SSE2:   return "sse2";
+    case PIXEL_FX_PATH_AVX2:   return "avx2";
+    default:                   return "unknown";
+    }
+}
+
+const char* pixel_fx_get_op_name(PixelFxOp op)
+{
+    switch (op) {
+    case PIXEL_FX_GRAYSCALE: return "grayscale";
+    case PIXEL_FX_INVERT:    return "invert";
+    case PIXEL_FX_CONTRAST:  return "contrast";
+    case PIXEL_FX_THRESHOLD: return "threshold";
+    case PIXEL_FX_ALPHA:     return "alpha";
+    default:                 return "unknown";
+    }
+}
+
+static int kernel_param(PixelFxOp op, double param)
+{
+    switch (op) {
+    case PIXEL_FX_CONTRAST:  return (int)(CLAMP(param, 0.0, 8.0) * 512 + 0.5);
+    case PIXEL_FX_THRESHOLD: return (int)CLAMP(param, 0.0, 256.0);
+    case PIXEL_FX_ALPHA:     return (int)CLAMP(param, 0.0, 255.0);
+    default:                 return 0;
+    }
+}
+
+static void run_row(const KernelSet *set, PixelFxOp op, const Uint32 *src, Uint32 *dst, int n, int param)
+{
+    if (op < 0 || op >= PIXEL_FX_OP_COUNT || n <= 0) return;
+    set->ops[op](src, dst, n, param);
+}
+
+void pixel_fx_row(PixelFxOp op, const Uint32 *src, Uint32 *dst, int n, double param)
+{
+    run_row(path_kernels(pixel_fx_get_path()), op, src, dst, n, kernel_param(op, param));
+}
+
+int pixel_fx_surface(PixelFxOp op, SDL_Surface *src, SDL_Surface *dst, double param)
+{
+    if (!src || !dst || src->w != dst->w || src->h != dst->h ||
+        src->format->format != SDL_PIXELFORMAT_ARGB8888 ||
+        dst->format->format != SDL_PIXELFORMAT_ARGB8888)
+        return -1;
+
+    const KernelSet *set = path_kernels(pixel_fx_get_path());
+    int k = kernel_param(op, param);
+
+    SDL_LockSurface(src);
+    if (dst != src) SDL_LockSurface(dst);
+
+    for (int y = 0; y < src->h; y++) {
+        const Uint32 *in = (const Uint32 *)((const Uint8 *)src->pixels + y * src->pitch);
+        Uint32 *out = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+        run_row(set, op, in, out, src->w, k);
+    }
+
+    if (dst != src) SDL_UnlockSurface(dst);
+    SDL_UnlockSurface(src);
+    return 0;
+}
+
+// Microbenchmark
+void pixel_fx_benchmark(void)
+{
+    const int w = 1920, h = 1080, n = w * h;
+    const double params[PIXEL_FX_OP_COUNT] = { 0, 0, 1.5, 128, 128 };
+
+    Uint32 *src = g_malloc(sizeof(Uint32) * n);
+    Uint32 *dst = g_malloc(sizeof(Uint32) * n);
+    for (int i = 0; i < n; i++)
+        src[i] = (Uint32)g_random_int();
+
+    for (int p = 0; p < PIXEL_FX_PATH_COUNT; p++) {
+        if (!path_supported(p)) continue;
+        const KernelSet *set = path_kernels(p);
+
+        for (int op = 0; op < PIXEL_FX_OP_COUNT; op++) {
+            int k = kernel_param(op, params[op]);
+            int runs = 0;
+            gint64 start = g_get_monotonic_time(), elapsed;
+            do {
+                run_row(set, op, src, dst, n, k);
+                runs++;
+                elapsed = g_get_monotonic_time() - start;
+            } while (elapsed < 200000);
+
+            g_print("[FX] %-6s %-9s %8.1f Mpx/s\n", pixel_fx_get_path_name(p), pixel_fx_get_op_name(op),
+                    (double)n * runs / elapsed);
+        }
+    }
+
+    g_free(src);
+    g_free(dst);
+}
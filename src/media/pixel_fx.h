@@ -0,0 +1,39 @@
+#ifndef PIXEL_FX_H
+#define PIXEL_FX_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+// Point-operation kernels on ARGB8888 rows. The AVX2 / SSE2 / scalar
+// path is picked once at runtime (override: PULSRR_PIXEL_FX=scalar|sse2|avx2);
+// every path produces identical output. Alpha is kept unless stated.
+typedef enum {
+    PIXEL_FX_GRAYSCALE,     // (R + G + B) / 3
+    PIXEL_FX_INVERT,        // 255 - c
+    PIXEL_FX_CONTRAST,      // (c - 128) * param + 128, param in [0, 8]
+    PIXEL_FX_THRESHOLD,     // gray >= param ? white : black
+    PIXEL_FX_ALPHA,         // A * param / 255, param in [0, 255]
+    PIXEL_FX_OP_COUNT
+} PixelFxOp;
+
+typedef enum {
+    PIXEL_FX_PATH_SCALAR,
+    PIXEL_FX_PATH_SSE2,
+    PIXEL_FX_PATH_AVX2,
+    PIXEL_FX_PATH_COUNT
+} PixelFxPath;
+
+PixelFxPath pixel_fx_get_path(void);
+const char* pixel_fx_get_path_name(PixelFxPath path);
+const char* pixel_fx_get_op_name(PixelFxOp op);
+
+// `n` pixels from src to dst (src == dst is allowed)
+void pixel_fx_row(PixelFxOp op, const Uint32 *src, Uint32 *dst, int n, double param);
+
+// Whole surfaces, both ARGB8888 and the same size (src == dst is allowed)
+int pixel_fx_surface(PixelFxOp op, SDL_Surface *src, SDL_Surface *dst, double param);
+
+// Log pixels per second of every kernel on every path this CPU supports
+void pixel_fx_benchmark(void);
+
+#endif // PIXEL_FX_H
@@ -0,0 +1,115 @@
+/* Pre-scaled source frames for the bake */
+#include "scale_cache.h"
+
+#include <stdlib.h>
+
+struct ScaleCache {
+    GMutex      lock;
+    GHashTable *frames;      // key -> SDL_Surface (one reference held here)
+    int         width;
+    int         height;
+    gint64      bytes;
+    gint64      max_bytes;
+    int         hits;
+    int         misses;
+};
+
+static gint64 cache_max_bytes(void)
+{
+    const char *env = g_getenv("PULSRR_SCALE_CACHE_MB");
+    if (env && *env && atoi(env) >= 0) return (gint64)atoi(env) * 1024 * 1024;
+    return SCALE_CACHE_MAX_BYTES;
+}
+
+// Source indices stay below 2^24
+static gpointer frame_key(int layer, int index)
+{
+    return GUINT_TO_POINTER(((guint)layer << 24) | ((guint)index & 0xFFFFFF));
+}
+
+ScaleCache* scale_cache_new(int width, int height)
+{
+    ScaleCache *cache = g_new0(ScaleCache, 1);
+    g_mutex_init(&cache->lock);
+    cache->frames = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                          (GDestroyNotify)SDL_FreeSurface);
+    cache->width = width;
+    cache->height = height;
+    cache->max_bytes = cache_max_bytes();
+    return cache;
+}
+
+void scale_cache_free(ScaleCache *cache)
+{
+    if (!cache) return;
+
+    g_print("[BAKE] Scale cache: %d hits, %d misses, %u frames kept (%.1f MB)\n",
+            cache->hits, cache->misses, g_hash_table_size(cache->frames),
+            cache->bytes / (1024.0 * 1024.0));
+
+    g_hash_table_destroy(cache->frames);
+    g_mutex_clear(&cache->lock);
+    g_free(cache);
+}
+
+SDL_Surface* scale_cache_lookup(ScaleCache *cache, int layer, int index)
+{
+    g_mutex_lock(&cache->lock);
+    SDL_Surface *scaled = g_hash_table_lookup(cache->frames, frame_key(layer, index));
+    if (scaled) {
+        scaled->refcount++;
+        cache->hits++;
+    }
+    g_mutex_unlock(&cache->lock);
+    return scaled;
+}
+
+SDL_Surface* scale_cache_insert(ScaleCache *cache, int layer, int index, SDL_Surface *src)
+{
+    SDL_Surface *scaled = SDL_CreateRGBSurfaceWithFormat(0, cache->width, cache->height,
+                                                         32, SDL_PIXELFORMAT_ARGB8888);
+    // Private header over the source pixels, copied without blending
+    SDL_Surface *view = SDL_CreateRGBSurfaceWithFormatFrom(src->pixels, src->w, src->h, 32,
+                                                           src->pitch, src->format->format);
+    if (!scaled || !view) {
+        SDL_FreeSurface(scaled);
+        SDL_FreeSurface(view);
+        return NULL;
+    }
+    SDL_SetSurfaceBlendMode(view, SDL_BLENDMODE_NONE);
+    SDL_BlitScaled(view, NULL, scaled, NULL);
+    SDL_FreeSurface(view);
+
+    gint64 size = (gint64)scaled->pitch * scaled->h;
+    gpointer key = frame_key(layer, index);
+
+    g_mutex_lock(&cache->lock);
+    cache->misses++;
+
+    // Another worker may have scaled the same frame meanwhile
+    SDL_Surface *kept = g_hash_table_lookup(cache->frames, key);
+    if (kept) {
+        kept->refcount++;
+        g_mutex_unlock(&cache->lock);
+        SDL_FreeSurface(scaled);
+        return kept;
+    }
+
+    if (cache->bytes + size <= cache->max_bytes) {
+        scaled->refcount++;
+        g_hash_table_insert(cache->frames, key, scaled);
+        cache->bytes += size;
+    }
+    g_mutex_unlock(&cache->lock);
+    return scaled;
+}
+
+void scale_cache_release(ScaleCache *cache, SDL_Surface *scaled)
+{
+    if (!scaled) return;
+
+    // Reference counts are shared between workers
+    g_mutex_lock(&cache->lock);
+    SDL_FreeSurface(scaled);
+    g_mutex_unlock(&cache->lock);
+}
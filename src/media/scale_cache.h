@@ -0,0 +1,30 @@
+#ifndef SCALE_CACHE_H
+#define SCALE_CACHE_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+// Source frames scaled once to the bake output size, shared by the mix
+// workers and keyed by (layer, source frame). Looping clips cycle through
+// every frame, which defeats LRU eviction, so once the cache is full it
+// keeps what it holds and later frames are scaled for a single use.
+#define SCALE_CACHE_MAX_BYTES (512 * 1024 * 1024)   // override: PULSRR_SCALE_CACHE_MB
+
+typedef struct ScaleCache ScaleCache;
+
+ScaleCache* scale_cache_new(int width, int height);
+void scale_cache_free(ScaleCache *cache);
+
+// Surfaces returned below are ARGB8888 at the output size, shared and
+// read-only; each one is handed back with scale_cache_release.
+// Blit them through a private header (SDL caches blit state in the source).
+
+// NULL on a miss
+SDL_Surface* scale_cache_lookup(ScaleCache *cache, int layer, int index);
+
+// Scale `src` and keep it if there is room; NULL if out of memory
+SDL_Surface* scale_cache_insert(ScaleCache *cache, int layer, int index, SDL_Surface *src);
+
+void scale_cache_release(ScaleCache *cache, SDL_Surface *scaled);
+
+#endif // SCALE_CACHE_H
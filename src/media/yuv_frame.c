@@ -0,0 +1,107 @@
+/* Planar YUV420 frames */
+#include "yuv_frame.h"
+
+// YUV -> RGB coefficients in 1/1024 units
+typedef struct {
+    int y_offset;
+    int y, rv, gu, gv, bu;
+} YuvMatrix;
+
+static const YuvMatrix matrix_jpeg  = {  0, 1024, 1436, 352, 731, 1815 };  // full range
+static const YuvMatrix matrix_bt601 = { 16, 1192, 1634, 401, 832, 2066 };
+static const YuvMatrix matrix_bt709 = { 16, 1192, 1836, 218, 546, 2163 };
+
+// Selection
+FrameFormat frame_format_get_default(void)
+{
+    const char *env = g_getenv("PULSRR_FRAME_FORMAT");
+    if (!env || !*env || g_ascii_strcasecmp(env, "argb") == 0) return FRAME_FORMAT_ARGB8888;
+    if (g_ascii_strcasecmp(env, "yuv420") == 0 || g_ascii_strcasecmp(env, "yuv") == 0)
+        return FRAME_FORMAT_YUV420;
+
+    g_printerr("[YUV] Unknown PULSRR_FRAME_FORMAT '%s', using ARGB8888\n", env);
+    return FRAME_FORMAT_ARGB8888;
+}
+
+const char* frame_format_get_name(FrameFormat format)
+{
+    return format == FRAME_FORMAT_YUV420 ? "YUV420" : "ARGB8888";
+}
+
+YuvFrame* yuv_frame_new(int width, int height)
+{
+    if (width <= 0 || height <= 0) return NULL;
+
+    int cw = (width + 1) / 2;
+    int ch = (height + 1) / 2;
+    gsize luma = (gsize)width * height;
+    gsize chroma = (gsize)cw * ch;
+
+    YuvFrame *frame = g_new0(YuvFrame, 1);
+    frame->width = width;
+    frame->height = height;
+    frame->planes[0] = g_try_malloc(luma + 2 * chroma);
+    if (!frame->planes[0]) {
+        g_free(frame);
+        return NULL;
+    }
+    frame->planes[1] = frame->planes[0] + luma;
+    frame->planes[2] = frame->planes[1] + chroma;
+    frame->pitches[0] = width;
+    frame->pitches[1] = cw;
+    frame->pitches[2] = cw;
+    return frame;
+}
+
+void yuv_frame_free(YuvFrame *frame)
+{
+    if (!frame) return;
+    g_free(frame->planes[0]);
+    g_free(frame);
+}
+
+static inline Uint32 clamp_channel(int v)
+{
+    v = (v + 512) >> 10;
+    return v < 0 ? 0 : v > 255 ? 255 : (Uint32)v;
+}
+
+static const YuvMatrix* frame_matrix(const YuvFrame *frame)
+{
+    switch (SDL_GetYUVConversionModeForResolution(frame->width, frame->height)) {
+        case SDL_YUV_CONVERSION_JPEG:  return &matrix_jpeg;
+        case SDL_YUV_CONVERSION_BT709: return &matrix_bt709;
+        default:                       return &matrix_bt601;
+    }
+}
+
+void yuv_frame_row_to_argb(const YuvFrame *frame, int y, Uint32 *dst)
+{
+    const YuvMatrix *m = frame_matrix(frame);
+    const Uint8 *py = frame->planes[0] + y * frame->pitches[0];
+    const Uint8 *pu = frame->planes[1] + (y / 2) * frame->pitches[1];
+    const Uint8 *pv = frame->planes[2] + (y / 2) * frame->pitches[2];
+
+    for (int x = 0; x < frame->width; x++) {
+        int c = (py[x] - m->y_offset) * m->y;
+        int u = pu[x / 2] - 128;
+        int v = pv[x / 2] - 128;
+        dst[x] = 0xFF000000u
+               | clamp_channel(c + m->rv * v) << 16
+               | clamp_channel(c - m->gu * u - m->gv * v) << 8
+               | clamp_channel(c + m->bu * u);
+    }
+}
+
+int yuv_frame_to_surface(const YuvFrame *frame, SDL_Surface *dst)
+{
+    if (!frame || !dst || dst->w != frame->width || dst->h != frame->height ||
+        dst->format->format != SDL_PIXELFORMAT_ARGB8888)
+        return -1;
+
+    SDL_LockSurface(dst);
+    for (int y = 0; y < frame->height; y++)
+        yuv_frame_row_to_argb(frame, y, (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch));
+    SDL_UnlockSurface(dst);
+    return 0;
+}
@@ -0,0 +1,36 @@
+#ifndef YUV_FRAME_H
+#define YUV_FRAME_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+// In-memory layout of decoded frames
+typedef enum {
+    FRAME_FORMAT_ARGB8888,  // 4 bytes per pixel, ready for FX and blits
+    FRAME_FORMAT_YUV420     // planar 4:2:0, 1.5 bytes per pixel
+} FrameFormat;
+
+// Selection (PULSRR_FRAME_FORMAT=argb|yuv420, ARGB8888 by default)
+FrameFormat frame_format_get_default(void);
+const char* frame_format_get_name(FrameFormat format);
+
+// Planar YUV420 frame in SDL_PIXELFORMAT_IYUV plane order (Y, U, V), one
+// allocation. Chroma planes are half size, rounded up.
+typedef struct {
+    int    width;
+    int    height;
+    Uint8 *planes[3];
+    int    pitches[3];
+} YuvFrame;
+
+YuvFrame* yuv_frame_new(int width, int height);
+void yuv_frame_free(YuvFrame *frame);
+
+// Row `y` to ARGB8888 (opaque), with the matrix SDL picks for this size
+// (SDL_GetYUVConversionModeForResolution), so CPU and GPU paths agree
+void yuv_frame_row_to_argb(const YuvFrame *frame, int y, Uint32 *dst);
+
+// Whole frame into an ARGB8888 surface of the same size
+int yuv_frame_to_surface(const YuvFrame *frame, SDL_Surface *dst);
+
+#endif // YUV_FRAME_H
@@ -1,10 +1,73 @@
 #include "modal_add_sequence.h"
 #include "../utils/utils.h"
 #include "../sdl/sdl.h"
+#include "../sdl/gpu_bake.h"
 #include "../components/component_sequencer.h"
 #include "../utils/accessor.h"
+#include "../media/decoder.h"
+#include "../media/frame_pack.h"
+#include "../media/frame_sink.h"
+#include "../media/scale_cache.h"
 #include <SDL2/SDL_image.h>
 
+// One Add Sequence run, handed to the worker thread
+typedef struct {
+    AddSequenceUI *ui;
+    gchar *seq_dir;
+    int duration;
+    int width;
+    int height;
+    gboolean completed;
+} SequenceBake;
+
+// Bakes always run at this rate
+#define BAKE_FPS 25
+
+// Output frames per mix job: small, so finished frames stay close to the writer
+#define MIX_CHUNK_FRAMES 8
+
+// Pack, PNG folder, MP4
+#define MIX_MAX_SINKS 3
+
+// Shared by the mix workers; layers and sources are read-only while they run
+typedef struct {
+    const Layer *layers;
+    YuvFrame ***yuv_frames;
+    int width;
+    int height;
+    const gchar *sequence_folder;
+    gint *cancelled;
+    GpuBake *gpu;               // frames come from the offscreen bake (NULL = mixed here)
+    ScaleCache *scaled;         // CPU mix: source frames at output size
+
+    // Every mixed frame goes to each sink still open
+    FrameSink *sinks[MIX_MAX_SINKS];
+    gint open[MIX_MAX_SINKS];   // cleared once a sink failed
+    int n_sinks;
+
+    GMutex lock;
+    GCond ready;
+    GByteArray **encoded;       // MIX_MAX_SINKS payloads per output frame
+    gboolean *finished;         // per output frame
+} MixContext;
+
+typedef struct {
+    MixContext *ctx;
+    int first;
+    int last;                   // exclusive
+} MixChunk;
+
+typedef struct {
+    AddSequenceUI *ui;
+    char *msg;
+} SequenceLog;
+
+typedef struct {
+    AddSequenceUI *ui;
+    double fraction;
+    char *text;
+} SequenceProgress;
+
 int encode_frames_folder_with_ffmpeg(const gchar *frames_folder, const gchar *output_mp4, int fps, int width, int height)
 {
     if (!g_file_test(frames_folder, G_FILE_TEST_IS_DIR)) {
@@ -29,9 +92,140 @@ int encode_frames_folder_with_ffmpeg(const gchar *frames_folder, const gchar *ou
     return 0;
 }
 
-void generate_sequence_frames(int duration, int width, int height, const gchar *sequence_folder, AddSequenceUI *ui)
+// Source frame shown at output frame `f`: the layer's time base, as live
+static int mix_source_index(const Layer *layer, int f)
+{
+    Uint64 t = (Uint64)f * 1000000000ULL / BAKE_FPS;
+    return frame_time_base_frame(&layer->timebase, t, layer->frame_count);
+}
+
+// Per-worker surfaces, kept across the frames of a chunk
+typedef struct {
+    SDL_Surface *scratch[MAX_LAYERS];   // YUV frames converted at source size
+    SDL_Surface *held[MAX_LAYERS];      // scaled frame of the previous output frame
+    int held_index[MAX_LAYERS];
+} MixWorker;
+
+// Layer source frame `index` at full output size, from the scale cache or
+// scaled now; released with scale_cache_release
+static SDL_Surface* mix_scaled_source(MixContext *ctx, MixWorker *w, int l, int index)
+{
+    SDL_Surface *scaled = scale_cache_lookup(ctx->scaled, l, index);
+    if (scaled) return scaled;
+
+    const Layer *layer = &ctx->layers[l];
+    SDL_Surface *src = layer->frames ? layer->frames[index] : NULL;
+
+    if (ctx->yuv_frames[l] && ctx->yuv_frames[l][index]) {
+        // Converted on the fly into the per-layer scratch surface
+        const YuvFrame *yuv = ctx->yuv_frames[l][index];
+        if (!w->scratch[l] || w->scratch[l]->w != yuv->width || w->scratch[l]->h != yuv->height) {
+            SDL_FreeSurface(w->scratch[l]);
+            w->scratch[l] = SDL_CreateRGBSurfaceWithFormat(0, yuv->width, yuv->height,
+                                                           32, SDL_PIXELFORMAT_ARGB8888);
+        }
+        if (w->scratch[l] && yuv_frame_to_surface(yuv, w->scratch[l]) == 0) {
+            fx_chain_apply_surface(&layer->fx, w->scratch[l], w->scratch[l]);
+            src = w->scratch[l];
+        }
+    }
+    return src ? scale_cache_insert(ctx->scaled, l, index, src) : NULL;
+}
+
+// Composite output frame `f` into `mixed`
+static void mix_frame(MixContext *ctx, int f, SDL_Surface *mixed, MixWorker *w)
+{
+    SDL_FillRect(mixed, NULL, SDL_MapRGBA(mixed->format, 0, 0, 0, 255));
+
+    for (int l = 0; l < MAX_LAYERS; l++) {
+        const Layer *layer = &ctx->layers[l];
+        if (layer->frame_count == 0) continue;
+
+        // Slowed layers repeat source frames on consecutive output frames
+        int frame_idx = mix_source_index(layer, f);
+        if (!w->held[l] || w->held_index[l] != frame_idx) {
+            scale_cache_release(ctx->scaled, w->held[l]);
+            w->held[l] = mix_scaled_source(ctx, w, l, frame_idx);
+            w->held_index[l] = frame_idx;
+        }
+        SDL_Surface *src = w->held[l];
+        if (!src) continue;
+
+        // Cached frames are blitted through a private header: SDL caches the
+        // blit mapping in the source surface, which workers must not share
+        SDL_Surface *blit = SDL_CreateRGBSurfaceWithFormatFrom(src->pixels, src->w, src->h, 32,
+                                                               src->pitch, src->format->format);
+        if (!blit) continue;
+
+        SDL_SetSurfaceBlendMode(blit, SDL_BLENDMODE_BLEND);
+        SDL_SetSurfaceAlphaMod(blit, layer->alpha);
+
+        // Already at output size: a plain 1:1 blend
+        SDL_BlitSurface(blit, NULL, mixed, NULL);
+        SDL_FreeSurface(blit);
+    }
+}
+
+// Pool worker: mixes and encodes one frame range with its own surfaces
+static void run_mix_chunk(gpointer data, gpointer user_data)
+{
+    (void)user_data;
+    MixChunk *chunk = data;
+    MixContext *ctx = chunk->ctx;
+
+    SDL_Surface *mixed = ctx->gpu ? NULL
+                       : SDL_CreateRGBSurface(0, ctx->width, ctx->height, 32,
+                                              0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+    MixWorker worker = {0};
+
+    for (int f = chunk->first; f < chunk->last; f++) {
+        GByteArray *out[MIX_MAX_SINKS] = {0};
+        SDL_Surface *frame = NULL;
+
+        // Cancelled frames still finish, empty, so the writer never stalls
+        if (!g_atomic_int_get(ctx->cancelled)) {
+            if (ctx->gpu) {
+                frame = gpu_bake_take(ctx->gpu, f);
+            } else if (mixed) {
+                mix_frame(ctx, f, mixed, &worker);
+                frame = mixed;
+            }
+        }
+
+        if (frame) {
+            if (f == 0) {
+                gchar *preview = g_build_filename(ctx->sequence_folder, DECODER_PREVIEW_NAME, NULL);
+                IMG_SavePNG(frame, preview);
+                g_free(preview);
+            }
+
+            for (int s = 0; s < ctx->n_sinks; s++) {
+                if (!g_atomic_int_get(&ctx->open[s])) continue;
+                if (frame_sink_encode(ctx->sinks[s], f, frame, &out[s]) != 0)
+                    g_atomic_int_set(&ctx->open[s], 0);
+            }
+            if (frame != mixed) SDL_FreeSurface(frame);
+        }
+
+        g_mutex_lock(&ctx->lock);
+        memcpy(&ctx->encoded[f * MIX_MAX_SINKS], out, sizeof(out));
+        ctx->finished[f] = TRUE;
+        g_cond_broadcast(&ctx->ready);
+        g_mutex_unlock(&ctx->lock);
+    }
+
+    for (int l = 0; l < MAX_LAYERS; l++) {
+        SDL_FreeSurface(worker.scratch[l]);
+        scale_cache_release(ctx->scaled, worker.held[l]);
+    }
+    SDL_FreeSurface(mixed);
+    g_free(chunk);
+}
+
+gboolean generate_sequence_frames(int duration, int width, int height, const gchar *sequence_folder, AddSequenceUI *ui)
 {
     Layer layers[MAX_LAYERS] = {0};
+    YuvFrame **yuv_frames[MAX_LAYERS] = {0};     // planar clips, converted per use
     gchar layer_folder[PATH_MAX];
     gchar fx_path[PATH_MAX];
 
@@ -40,16 +234,18 @@ void generate_sequence_frames(int duration, int width, int height, const gchar *
     FILE *fx_file = fopen(fx_path, "r");
     if (!fx_file) {
         add_log(ui, "[ERROR] Cannot open fx.txt");
-        return;
+        return FALSE;
     }
 
     for (int i = 0; i < MAX_LAYERS; i++) {
         layers[i].speed = 1.0;
         layers[i].grayscale = 0;
+        layers[i].invert = 0;
+        layers[i].contrast = 1.0;
+        layers[i].threshold = 0;
         layers[i].alpha = 255;
         layers[i].frame_count = 0;
         layers[i].frames = NULL;
-        layers[i].frames_gray = NULL;
         layers[i].frame_folder = NULL;
     }
 
@@ -64,111 +260,255 @@ void generate_sequence_frames(int duration, int width, int height, const gchar *
             layers[current_layer].grayscale = atoi(line + 5);
         } else if (strncmp(line, "alpha=", 6) == 0 && current_layer >= 0) {
             layers[current_layer].alpha = atoi(line + 6);
+        } else if (strncmp(line, "invert=", 7) == 0 && current_layer >= 0) {
+            layers[current_layer].invert = atoi(line + 7);
+        } else if (strncmp(line, "contrast=", 9) == 0 && current_layer >= 0) {
+            layers[current_layer].contrast = atof(line + 9);
+        } else if (strncmp(line, "threshold=", 10) == 0 && current_layer >= 0) {
+            layers[current_layer].threshold = atoi(line + 10);
         }
     }
     fclose(fx_file);
 
-    // Load frames for each layer
+    // Load frames for each layer (video sources may stay YUV420 to save RAM)
     set_progress_add_sequence(ui, 0.1, "Loading layers...");
-    for (int i = 0; i < MAX_LAYERS; i++) {
+    gboolean keep_yuv = frame_format_get_default() == FRAME_FORMAT_YUV420;
+    for (int i = 0; i < MAX_LAYERS && !g_atomic_int_get(&ui->cancelled); i++) {
         snprintf(layer_folder, sizeof(layer_folder), "%s/Frames_%d", sequence_folder, i + 1);
         layers[i].frame_folder = g_strdup(layer_folder);
-        layers[i].frame_count = count_frames(layers[i].frame_folder);
+        if (keep_yuv)
+            yuv_frames[i] = decoder_load_folder_yuv(layers[i].frame_folder, &layers[i].frame_count);
+        if (!yuv_frames[i])
+            layers[i].frames = decoder_load_folder(layers[i].frame_folder, &layers[i].frame_count);
         if (layers[i].frame_count == 0) continue;
 
-        layers[i].frames = malloc(sizeof(SDL_Surface*) * layers[i].frame_count);
-        layers[i].frames_gray = malloc(sizeof(SDL_Surface*) * layers[i].frame_count);
+        // Same rate as the layer plays at live
+        DecoderManifest manifest;
+        layers[i].fps = MASTER_FPS;
+        if (decoder_read_manifest(layers[i].frame_folder, &manifest) == 0) {
+            if (manifest.fps > 0) layers[i].fps = manifest.fps;
+            decoder_free_manifest(&manifest);
+        }
+        frame_time_base_init(&layers[i].timebase, layers[i].fps, 1, 0);
+        frame_time_base_set_speed(&layers[i].timebase, layers[i].speed, 0);
 
-        for (int f = 0; f < layers[i].frame_count; f++) {
-            gchar frame_file[PATH_MAX];
-            snprintf(frame_file, sizeof(frame_file), "%s/frame_%05d.png", layers[i].frame_folder, f + 1);
-            SDL_Surface *surf = IMG_Load(frame_file);
-            layers[i].frames[f] = surf;
+        FxParams params = { layers[i].grayscale, layers[i].invert, layers[i].contrast, layers[i].threshold };
+        fx_chain_compile(&layers[i].fx, &params);
 
-			SDL_Surface *surf_gray = NULL;
-			if (layers[i].grayscale) {
-				surf_gray = create_grayscale_surface(surf);
-			} else {
-				surf_gray = NULL;
-			}
-			layers[i].frames_gray[f] = surf_gray;
+        add_log(ui, g_strdup_printf("[LOAD] Layer %d loaded (%d frames)", i + 1, layers[i].frame_count));
+    }
 
-        }
+    int total_output_frames = duration * BAKE_FPS;
 
-        add_log(ui, g_strdup_printf("[LOAD] Layer %d loaded (%d frames)", i + 1, layers[i].frame_count));
+    // Offscreen bake with the live draw code, on request; mixed here otherwise
+    GpuBake *gpu = NULL;
+    if (g_strcmp0(g_getenv("PULSRR_BAKE"), "gpu") == 0 && !g_atomic_int_get(&ui->cancelled)) {
+        gpu = gpu_bake_start(layers, yuv_frames, width, height, total_output_frames,
+                             BAKE_FPS, &ui->cancelled);
+        add_log(ui, gpu ? "[INFO] Baking on the GPU" : "[WARN] GPU bake unavailable, mixing on the CPU");
     }
 
-    // Prepare mixed_frames folder
-    gchar mixed_dir[PATH_MAX];
-    snprintf(mixed_dir, sizeof(mixed_dir), "%s/mixed_frames", sequence_folder);
-    ensure_dir(mixed_dir);
+    // CPU mix: all point FX in one in-place pass per frame
+    for (int i = 0; !gpu && i < MAX_LAYERS; i++) {
+        if (layers[i].fx.identity || !layers[i].frames) continue;
+        for (int f = 0; f < layers[i].frame_count; f++)
+            if (layers[i].frames[f] && fx_chain_apply_surface(&layers[i].fx, layers[i].frames[f], layers[i].frames[f]) != 0)
+                add_log(ui, g_strdup_printf("[WARN] Layer %d frame %d: FX skipped", i + 1, f + 1));
+    }
 
-    int total_output_frames = duration * 25; // fixed 25 FPS
-    set_progress_add_sequence(ui, 0.5, "Mixing frames...");
+    // Mixed frames go to a single pack; PNG folder and MP4 on request
+    MixContext ctx = {
+        .layers = layers,
+        .yuv_frames = yuv_frames,
+        .width = width,
+        .height = height,
+        .sequence_folder = sequence_folder,
+        .cancelled = &ui->cancelled,
+        .gpu = gpu,
+        .scaled = gpu ? NULL : scale_cache_new(width, height),
+    };
+
+    gchar pack_path[PATH_MAX];
+    snprintf(pack_path, sizeof(pack_path), "%s/%s", sequence_folder, FRAME_PACK_NAME);
+    FrameCodec codec = frame_codec_get_default();
+    int pack_sink = -1;     // required output; PNG and MP4 may fail alone
+    ctx.sinks[ctx.n_sinks] = frame_sink_pack_new(pack_path, codec, width, height, BAKE_FPS);
+    if (ctx.sinks[ctx.n_sinks]) pack_sink = ctx.n_sinks++;
+    else add_log(ui, g_strdup_printf("[ERROR] Cannot create %s", pack_path));
+    frame_codec_reset_stats();
+
+    if (g_getenv("PULSRR_EXPORT_PNG")) {
+        gchar *mixed_dir = g_build_filename(sequence_folder, "mixed_frames", NULL);
+        ctx.sinks[ctx.n_sinks] = frame_sink_png_new(mixed_dir);
+        if (ctx.sinks[ctx.n_sinks]) ctx.n_sinks++;
+        g_free(mixed_dir);
+    }
 
-    for (int f = 0; f < total_output_frames; f++) {
-        SDL_Surface *mixed = SDL_CreateRGBSurface(0, width, height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
-        SDL_FillRect(mixed, NULL, SDL_MapRGBA(mixed->format, 0, 0, 0, 255));
-
-        for (int l = 0; l < MAX_LAYERS; l++) {
-            if (layers[l].frame_count == 0) continue;
-
-            int frame_idx;
-            if (layers[l].speed >= 1.0)
-                frame_idx = (int)(f * layers[l].speed) % layers[l].frame_count;
-            else {
-                int repeat = (int)(1.0 / layers[l].speed + 0.5);
-                frame_idx = (f / repeat) % layers[l].frame_count;
-            }
+    // Encoded in the same pass, no intermediate images
+    if (g_getenv("PULSRR_EXPORT_MP4")) {
+        gchar *name = g_path_get_basename(sequence_folder);
+        gchar *mp4_name = g_strdup_printf("%s.mp4", name);
+        gchar *mp4_path = g_build_filename(sequence_folder, mp4_name, NULL);
+        ctx.sinks[ctx.n_sinks] = frame_sink_ffmpeg_new(mp4_path, width, height, BAKE_FPS, 0, 0);
+        if (ctx.sinks[ctx.n_sinks]) ctx.n_sinks++;
+        else add_log(ui, g_strdup_printf("[ERROR] Cannot start FFmpeg for %s", mp4_path));
+        g_free(name);
+        g_free(mp4_name);
+        g_free(mp4_path);
+    }
 
-            SDL_Surface *src = layers[l].grayscale ? layers[l].frames_gray[frame_idx] : layers[l].frames[frame_idx];
-            if (!src) continue;
+    for (int s = 0; s < ctx.n_sinks; s++)
+        ctx.open[s] = 1;
 
-            SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
-            SDL_SetSurfaceAlphaMod(src, layers[l].alpha);
+    set_progress_add_sequence(ui, 0.5, "Mixing frames...");
 
-            SDL_Rect dest = {0, 0, width, height};
-            SDL_BlitScaled(src, NULL, mixed, &dest);
-        }
+    // Frames are independent: ranges are mixed and encoded on a pool, the
+    // sinks are still fed in frame order from here
+    g_mutex_init(&ctx.lock);
+    g_cond_init(&ctx.ready);
+    ctx.encoded = g_new0(GByteArray *, (gsize)total_output_frames * MIX_MAX_SINKS);
+    ctx.finished = g_new0(gboolean, total_output_frames);
+
+    int threads = MAX((int)g_get_num_processors(), 1);
+    GThreadPool *mixers = g_thread_pool_new(run_mix_chunk, NULL, threads, FALSE, NULL);
+    for (int f = 0; f < total_output_frames; f += MIX_CHUNK_FRAMES) {
+        MixChunk *chunk = g_new0(MixChunk, 1);
+        chunk->ctx = &ctx;
+        chunk->first = f;
+        chunk->last = MIN(f + MIX_CHUNK_FRAMES, total_output_frames);
+        g_thread_pool_push(mixers, chunk, NULL);
+    }
+
+    // Failed sinks stay allocated until the workers are joined: a worker
+    // may still be encoding for one
+    gboolean dropped[MIX_MAX_SINKS] = {0};
 
-        gchar *frame_name = g_strdup_printf("frame_%05d.png", f + 1);
-        gchar *filename = g_build_filename(mixed_dir, frame_name, NULL);
-        IMG_SavePNG(mixed, filename);
-        g_free(frame_name);
-        g_free(filename);
-        SDL_FreeSurface(mixed);
+    for (int f = 0; f < total_output_frames; f++) {
+        GByteArray **out = &ctx.encoded[f * MIX_MAX_SINKS];
+
+        g_mutex_lock(&ctx.lock);
+        while (!ctx.finished[f])
+            g_cond_wait(&ctx.ready, &ctx.lock);
+        g_mutex_unlock(&ctx.lock);
+
+        for (int s = 0; s < ctx.n_sinks; s++) {
+            FrameSink *sink = ctx.sinks[s];
+            gboolean stored = FALSE;
+            if (dropped[s] || g_atomic_int_get(&ui->cancelled) || !g_atomic_int_get(&ctx.open[s])) {
+                if (out[s]) g_byte_array_free(out[s], TRUE);
+            } else {
+                stored = frame_sink_write(sink, f, out[s]) == 0;
+            }
+            out[s] = NULL;
+
+            // A sink that fails is dropped, the others carry on unless
+            // it was the pack
+            if (!stored && !dropped[s] && !g_atomic_int_get(&ui->cancelled)) {
+                add_log(ui, g_strdup_printf("[ERROR] Failed to store frame %d (%s)",
+                                            f + 1, frame_sink_get_name(sink)));
+                for (int d = 0; d < ctx.n_sinks; d++) {
+                    if (d != s && s != pack_sink) continue;
+                    g_atomic_int_set(&ctx.open[d], 0);
+                    dropped[d] = TRUE;
+                }
+            }
+        }
 
         if (f % (total_output_frames / 10) == 0)
             set_progress_add_sequence(ui, 0.5 + 0.4 * f / total_output_frames, "Mixing frames...");
     }
 
+    g_thread_pool_free(mixers, FALSE, TRUE);
+    gpu_bake_free(gpu);
+    scale_cache_free(ctx.scaled);
+    g_free(ctx.encoded);
+    g_free(ctx.finished);
+    g_mutex_clear(&ctx.lock);
+    g_cond_clear(&ctx.ready);
+
+    // Without its pack the sequence cannot play: the bake fails as a whole
+    gboolean cancelled = g_atomic_int_get(&ui->cancelled);
+    gboolean failed = cancelled || pack_sink < 0 || dropped[pack_sink];
+    for (int s = 0; s < ctx.n_sinks; s++) {
+        FrameSink *sink = ctx.sinks[s];
+
+        // Partial outputs are dropped; the caller removes the folder
+        const char *name = frame_sink_get_name(sink);
+        if (failed || dropped[s]) {
+            frame_sink_abort(sink);
+        } else if (frame_sink_finish(sink) != 0) {
+            add_log(ui, g_strdup_printf(s == pack_sink ? "[ERROR] Failed to finish the %s output"
+                                                       : "[WARN] Failed to finish the %s output", name));
+            if (s == pack_sink) failed = TRUE;
+        }
+    }
+    if (!failed)
+        add_log(ui, frame_codec_stats_summary(codec));
+
     // Cleanup
     for (int i = 0; i < MAX_LAYERS; i++) {
+        for (int f = 0; yuv_frames[i] && f < layers[i].frame_count; f++)
+            yuv_frame_free(yuv_frames[i][f]);
+        g_free(yuv_frames[i]);
+        g_free(layers[i].frame_folder);
         if (!layers[i].frames) continue;
-        for (int f = 0; f < layers[i].frame_count; f++) {
+        for (int f = 0; f < layers[i].frame_count; f++)
             if (layers[i].frames[f]) SDL_FreeSurface(layers[i].frames[f]);
-            if (layers[i].frames_gray[f]) SDL_FreeSurface(layers[i].frames_gray[f]);
-        }
-        free(layers[i].frames);
-        free(layers[i].frames_gray);
-        g_free(layers[i].frame_folder);
+        g_free(layers[i].frames);
     }
 
+    if (failed) return FALSE;
+
     set_progress_add_sequence(ui, 1.0, "Completed");
     add_log(ui, "[INFO] Sequence frames generated successfully.");
+    return TRUE;
 }
 
 
+static gboolean set_progress_idle(gpointer data)
+{
+    SequenceProgress *u = data;
+
+    if (!u->ui->closed) {
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(u->ui->progress_bar), u->fraction);
+        if (u->text)
+            gtk_progress_bar_set_text(GTK_PROGRESS_BAR(u->ui->progress_bar), u->text);
+    }
+
+    g_free(u->text);
+    g_free(u);
+    return G_SOURCE_REMOVE;
+}
+
+// Safe from any thread: applied on the UI thread
 void set_progress_add_sequence(AddSequenceUI *ui, double fraction, const char *text)
 {
-    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui->progress_bar), fraction);
+    SequenceProgress *u = g_new0(SequenceProgress, 1);
+    u->ui = ui;
+    u->fraction = fraction;
+    u->text = g_strdup(text);
+    g_idle_add(set_progress_idle, u);
+}
 
-    if (text) {
-        gtk_progress_bar_set_text(GTK_PROGRESS_BAR(ui->progress_bar), text);
+static void on_sequence_modal_destroyed(GtkWidget *widget, gpointer user_data)
+{
+    AddSequenceUI *ui = user_data;
+    ui->closed = TRUE;
+}
+
+// BACK closes the modal, or cancels the bake while one runs
+static void on_sequence_back_clicked(GtkButton *button, gpointer user_data)
+{
+    AddSequenceUI *ui = user_data;
+
+    if (ui->busy) {
+        g_atomic_int_set(&ui->cancelled, 1);
+        gtk_widget_set_sensitive(GTK_WIDGET(button), FALSE);
+        add_log(ui, "[INFO] Cancelling...");
+        return;
     }
 
-    while (gtk_events_pending())
-        gtk_main_iteration();
+    on_modal_back_clicked(button, get_app_ctx()->modal_layer);
 }
 
 void on_add_button_clicked(GtkButton *button, gpointer user_data) {
@@ -301,22 +641,41 @@ void on_add_button_clicked(GtkButton *button, gpointer user_data) {
 	ui->progress_bar = progress_bar;
 	ui->root_container = GTK_WIDGET(user_data);
 	ui->parent_container = black_box;
+	ui->export_button = btn_add_sequence;
+	ui->back_button = btn_back;
 
 	g_signal_connect(btn_add_sequence, "clicked", G_CALLBACK(on_add_sequence_clicked), ui);
-	g_signal_connect(btn_back, "clicked", G_CALLBACK(on_modal_back_clicked), app_ctx->modal_layer);
+	g_signal_connect(btn_back, "clicked", G_CALLBACK(on_sequence_back_clicked), ui);
+	g_signal_connect(black_box, "destroy", G_CALLBACK(on_sequence_modal_destroyed), ui);
 
 	gtk_container_add(GTK_CONTAINER(app_ctx->modal_layer), black_box);
 	gtk_widget_show_all(app_ctx->modal_layer);
 }
 
+static gboolean add_log_idle(gpointer data) {
+    SequenceLog *job = data;
+    AddSequenceUI *ui = job->ui;
+
+    if (!ui->closed) {
+        GtkTextIter end;
+        gtk_text_buffer_get_end_iter(ui->log_buffer, &end);
+        gtk_text_buffer_insert(ui->log_buffer, &end, job->msg, -1);
+        gtk_text_buffer_insert(ui->log_buffer, &end, "\n", -1);
+        GtkAdjustment *adj = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(ui->log_view));
+        gtk_adjustment_set_value(adj, gtk_adjustment_get_upper(adj));
+    }
+
+    g_free(job->msg);
+    g_free(job);
+    return G_SOURCE_REMOVE;
+}
+
+// Safe from any thread: appended on the UI thread
 void add_log(AddSequenceUI *ui, const char *message) {
-    GtkTextIter end;
-    gtk_text_buffer_get_end_iter(ui->log_buffer, &end);
-    gtk_text_buffer_insert(ui->log_buffer, &end, message, -1);
-    gtk_text_buffer_insert(ui->log_buffer, &end, "\n", -1);
-    GtkAdjustment *adj = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(ui->log_view));
-    gtk_adjustment_set_value(adj, gtk_adjustment_get_upper(adj));
-    while (gtk_events_pending()) gtk_main_iteration();
+    SequenceLog *job = g_new0(SequenceLog, 1);
+    job->ui = ui;
+    job->msg = g_strdup(message);
+    g_idle_add(add_log_idle, job);
 }
 
 void create_fx_file(const char *path, AddSequenceUI *ui)
@@ -338,6 +697,9 @@ void create_fx_file(const char *path, AddSequenceUI *ui)
         fprintf(f, "layer=%d\n", layer);
         fprintf(f, "speed=%f\n", speed);
         fprintf(f, "gray=%d\n", gray);
+        fprintf(f, "invert=%d\n", sdl_is_layer_inverted(layer));
+        fprintf(f, "contrast=%f\n", sdl_get_layer_contrast(layer));
+        fprintf(f, "threshold=%d\n", sdl_get_layer_threshold(layer));
         fprintf(f, "alpha=%d\n\n", alpha);
 
         gchar log_msg[128];
@@ -349,64 +711,113 @@ void create_fx_file(const char *path, AddSequenceUI *ui)
 }
 
 
-void on_add_sequence_clicked(GtkButton *button, gpointer user_data)
+// Back on the UI thread once the worker is done
+static gboolean add_sequence_done(gpointer data)
 {
+    SequenceBake *bake = data;
+    AddSequenceUI *ui = bake->ui;
+
+    if (bake->completed)
+        update_sequencer();
 
+    gtk_widget_set_sensitive(ui->root_container, TRUE);
+    ui->busy = FALSE;
+    g_atomic_int_set(&ui->cancelled, 0);
+
+    if (!ui->closed) {
+        gtk_widget_set_sensitive(ui->export_button, TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(ui->duration_spin), TRUE);
+        gtk_widget_set_sensitive(GTK_WIDGET(ui->scale_combo), TRUE);
+        gtk_widget_set_sensitive(ui->back_button, TRUE);
+        gtk_button_set_label(GTK_BUTTON(ui->back_button), "BACK");
+    }
+
+    g_free(bake->seq_dir);
+    g_free(bake);
+    return G_SOURCE_REMOVE;
+}
+
+static gpointer add_sequence_worker(gpointer data)
+{
+    SequenceBake *bake = data;
+    AddSequenceUI *ui = bake->ui;
+
+    set_progress_add_sequence(ui, 0.02, "Copy frame folders...");
+    for (int i = 1; i <= MAX_LAYERS && !g_atomic_int_get(&ui->cancelled); i++) {
+        gchar *src = g_strdup_printf("Frames_%d", i);
+        gchar *dst = g_build_filename(bake->seq_dir, src, NULL);
+        copy_directory(src, dst);
+        g_free(src);
+        g_free(dst);
+    }
+
+    gboolean generated = FALSE;
+    if (!g_atomic_int_get(&ui->cancelled)) {
+        add_log(ui, "[INFO] Add Sequence process start...");
+        generated = generate_sequence_frames(bake->duration, bake->width, bake->height, bake->seq_dir, ui);
+    }
+
+    if (g_atomic_int_get(&ui->cancelled)) {
+        // Nothing of a cancelled bake is kept
+        delete_dir_recursive(bake->seq_dir);
+        set_progress_add_sequence(ui, 0, "Cancelled");
+        add_log(ui, "[INFO] Add Sequence cancelled.");
+    } else if (!generated) {
+        // Nor of a failed one
+        delete_dir_recursive(bake->seq_dir);
+        set_progress_add_sequence(ui, 0, "Failed");
+        add_log(ui, "[ERROR] Add Sequence failed.");
+    } else {
+        add_log(ui, "[INFO] Add Sequence process completed.");
+        set_progress_add_sequence(ui, 0.9, "Updating sequence textures.");
+        update_sequence_texture();
+        set_progress_add_sequence(ui, 1, "Completed.");
+        bake->completed = TRUE;
+    }
+
+    g_idle_add(add_sequence_done, bake);
+    return NULL;
+}
+
+// The bake runs on a worker; the UI and the output stay live meanwhile
+void on_add_sequence_clicked(GtkButton *button, gpointer user_data)
+{
     AddSequenceUI *ui = (AddSequenceUI *)user_data;
-	gtk_widget_set_sensitive(ui->root_container, FALSE);
-	gtk_widget_set_sensitive(ui->parent_container, FALSE);
+    if (ui->busy) return;
+
+    ui->busy = TRUE;
+    g_atomic_int_set(&ui->cancelled, 0);
+    gtk_widget_set_sensitive(ui->root_container, FALSE);
+    gtk_widget_set_sensitive(ui->export_button, FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(ui->duration_spin), FALSE);
+    gtk_widget_set_sensitive(GTK_WIDGET(ui->scale_combo), FALSE);
+    gtk_button_set_label(GTK_BUTTON(ui->back_button), "CANCEL");
+
     gint duration = gtk_spin_button_get_value_as_int(ui->duration_spin);
     const gchar *scale = gtk_combo_box_text_get_active_text(ui->scale_combo);
     ensure_dir("sequences");
     int seq = get_next_sequence_index();
     gchar *seq_dir = g_strdup_printf("sequences/sequence_%d", seq);
-    ensure_dir(seq_dir); 
-	
-	set_progress_add_sequence(ui, 0.02, "Copy frame folders...");
-
-    gchar *dst = NULL;
-
-    dst = g_build_filename(seq_dir, "Frames_1", NULL);
-    copy_directory("Frames_1", dst);
-    g_free(dst);
+    ensure_dir(seq_dir);
 
-    dst = g_build_filename(seq_dir, "Frames_2", NULL);
-    copy_directory("Frames_2", dst);
-    g_free(dst);
+    // FX are read from the UI side now, as the bake starts
+    gchar *fx_path = g_build_filename(seq_dir, "fx.txt", NULL);
+    create_fx_file(fx_path, ui);
+    g_free(fx_path);
 
-    dst = g_build_filename(seq_dir, "Frames_3", NULL);
-    copy_directory("Frames_3", dst);
-    g_free(dst);
-
-    dst = g_build_filename(seq_dir, "Frames_4", NULL);
-    copy_directory("Frames_4", dst);
-    g_free(dst);
-
-	// Create fx.txt
-	gchar *fx_path = g_build_filename(seq_dir, "fx.txt", NULL);
-	create_fx_file(fx_path, ui);
-	g_free(fx_path);
-    
     //we gonna figure out the output width and height here
     int output_width = 1280, output_height = 720;
     if (strcmp(scale, "1080p") == 0) { output_width = 1920; output_height = 1080; }
     else if (strcmp(scale, "720p") == 0) { output_width = 1280; output_height = 720; }
     else if (strcmp(scale, "480p") == 0) { output_width = 854; output_height = 480; }
     else if (strcmp(scale, "360p") == 0) { output_width = 640; output_height = 360; }
-    
-    add_log(ui, "[INFO] Add Sequence process start...");
-    generate_sequence_frames(duration, output_width, output_height, seq_dir, ui);
-    add_log(ui, "[INFO] Add Sequence process completed.");
-    
-    set_progress_add_sequence(ui, 0.9, "Updating sequence textures.");
-    update_sequence_texture();
-    update_sequencer();
-    set_progress_add_sequence(ui, 1, "Completed.");
-
-    g_free(seq_dir);
-    gtk_widget_set_sensitive(ui->root_container, TRUE);
-    gtk_widget_set_sensitive(ui->parent_container, TRUE);
-    
-    
-}
 
+    SequenceBake *bake = g_new0(SequenceBake, 1);
+    bake->ui = ui;
+    bake->seq_dir = seq_dir;
+    bake->duration = duration;
+    bake->width = output_width;
+    bake->height = output_height;
+
+    g_thread_unref(g_thread_new("sequence-bake", add_sequence_worker, bake));
+}
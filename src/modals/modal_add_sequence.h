@@ -14,6 +14,11 @@ typedef struct {
     GtkTextBuffer *log_buffer;
     GtkWidget *progress_bar;
     GtkWidget *parent_container;
+    GtkWidget *export_button;
+    GtkWidget *back_button;
+    gboolean busy;              // a bake is running
+    gboolean closed;            // modal destroyed, drop late updates
+    gint cancelled;             // set from the UI, polled by the bake
 } AddSequenceUI;
 
 
@@ -26,7 +31,8 @@ void set_progress_add_sequence(AddSequenceUI *ui, double fraction, const char *t
 
 // Core Logic
 int encode_frames_folder_with_ffmpeg(const gchar *frames_folder, const gchar *output_mp4, int fps, int width, int height);
-void generate_sequence_frames(int duration, int width, int height, const gchar *sequence_folder, AddSequenceUI *ui);
+// Runs on the bake worker; FALSE if cancelled or fx.txt is missing
+gboolean generate_sequence_frames(int duration, int width, int height, const gchar *sequence_folder, AddSequenceUI *ui);
 
 #endif // MODAL_ADD_SEQUENCE_H
 
@@ -1,5 +1,7 @@
 #include "modal_download.h"
 #include "../utils/accessor.h"
+#include "../media/frame_pack.h"
+#include "../media/frame_sink.h"
 #define SEQUENCES_DIR "./sequences"
 
 typedef struct {
@@ -52,6 +54,31 @@ static gboolean ui_update_progress(gpointer data) {
     return G_SOURCE_REMOVE;
 }
 
+// Stream the frames of a pack into FFmpeg, no intermediate images
+static int encode_pack_with_ffmpeg(FramePack *pack, int fps, int width, int height, const char *output)
+{
+    int src_w, src_h;
+    frame_pack_get_size(pack, &src_w, &src_h);
+
+    FrameSink *sink = frame_sink_ffmpeg_new(output, src_w, src_h, fps, width, height);
+    if (!sink) return -1;
+
+    int count = frame_pack_get_frame_count(pack);
+    for (int f = 0; f < count; f++) {
+        SDL_Surface *surf = frame_pack_read_frame(pack, f);
+        if (!surf) continue;
+
+        int ret = frame_sink_put(sink, f, surf);
+        SDL_FreeSurface(surf);
+        if (ret != 0) {
+            frame_sink_abort(sink);
+            return -1;
+        }
+    }
+
+    return frame_sink_finish(sink);
+}
+
 // Run FFmpeg in a thread (temp video generation only)
 // Run FFmpeg in a thread
 static gpointer download_worker(gpointer data)
@@ -72,19 +99,13 @@ static gpointer download_worker(gpointer data)
     for (int i = 0; i < total_sequences; i++) {
         char *seq_path = g_list_nth_data(job->sequence_paths, i);
 
-        // Count frames
-        DIR *d = opendir(seq_path);
-        int total_frames = 0;
-        if (d) {
-            struct dirent *entry;
-            while ((entry = readdir(d)) != NULL) {
-                if (entry->d_type == DT_REG &&
-                    strstr(entry->d_name, "frame_") != NULL) {
-                    total_frames++;
-                }
-            }
-            closedir(d);
-        }
+        // Baked pack first, legacy mixed_frames PNGs otherwise
+        gchar *pack_path = g_build_filename(seq_path, FRAME_PACK_NAME, NULL);
+        FramePack *pack = frame_pack_open(pack_path);
+        g_free(pack_path);
+
+        gchar *png_dir = g_build_filename(seq_path, "mixed_frames", NULL);
+        int total_frames = pack ? frame_pack_get_frame_count(pack) : count_frames(png_dir);
 
         if (total_frames == 0) {
             // Update progress and log warning
@@ -102,6 +123,8 @@ static gpointer download_worker(gpointer data)
             lj->msg = g_strdup(msg);
             g_idle_add(log_message_idle, lj);
 
+            frame_pack_close(pack);
+            g_free(png_dir);
             continue;
         }
 
@@ -109,11 +132,11 @@ static gpointer download_worker(gpointer data)
         char temp_output[256];
         snprintf(temp_output, sizeof(temp_output), "./sequences/temp_seq_%d.mp4", i + 1);
 
-        // FFmpeg command for this sequence
+        // FFmpeg command for legacy PNG folders
         char ff_cmd[1024];
         snprintf(ff_cmd, sizeof(ff_cmd),
                  "ffmpeg -y -framerate %d -i \"%s/frame_%%05d.png\" -vf scale=%d:%d \"%s\"",
-                 job->fps, seq_path, width, height, temp_output);
+                 job->fps, png_dir, width, height, temp_output);
 
         // Log start
         char start_msg[128];
@@ -124,7 +147,10 @@ static gpointer download_worker(gpointer data)
         g_idle_add(log_message_idle, lj_start);
 
         // Run FFmpeg
-        int ret = system(ff_cmd);
+        int ret = pack ? encode_pack_with_ffmpeg(pack, job->fps, width, height, temp_output)
+                       : system(ff_cmd);
+        frame_pack_close(pack);
+        g_free(png_dir);
         if (ret != 0) {
             char err_msg[128];
             snprintf(err_msg, sizeof(err_msg), "[ERROR] Failed to encode sequence %d, skipping...", i + 1);
@@ -380,7 +406,7 @@ void on_dl_sequence_clicked(GtkButton *button, gpointer user_data) {
     int total_sequences = get_total_sequences();
     for (int i = 0; i < total_sequences; i++) {
         char path[256];
-        snprintf(path, sizeof(path), "sequences/sequence_%d/mixed_frames", i + 1);
+        snprintf(path, sizeof(path), "sequences/sequence_%d", i + 1);
         seq_list = g_list_append(seq_list, g_strdup(path));
     }
 
@@ -9,7 +9,7 @@
 
 typedef struct {
     AddSequenceUI *ui;
-    GList *sequence_paths; // list of folders: sequences/sequence_X/mixed_frames
+    GList *sequence_paths; // list of folders: sequences/sequence_X
     int fps;
     const char *scale; // e.g., "1080p", "720p"
 } DownloadJob;
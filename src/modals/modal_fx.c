@@ -8,14 +8,17 @@ void on_fx_apply_clicked(GtkButton *button, gpointer user_data) {
 	guint8 layer_index = fx->layer_index;
 	double speed = gtk_spin_button_get_value(fx->speed_spin);
 	int alpha = gtk_spin_button_get_value_as_int(fx->alpha_spin);
-	//int threshold = gtk_spin_button_get_value_as_int(fx->threshold_spin);
-	//double contrast = gtk_spin_button_get_value(fx->contrast_spin);
+	int threshold = gtk_spin_button_get_value_as_int(fx->threshold_spin);
+	double contrast = gtk_spin_button_get_value(fx->contrast_spin);
 	gboolean grayscale = gtk_toggle_button_get_active(fx->gray_check);
-	//gboolean invert = gtk_toggle_button_get_active(fx->invert_check);
+	gboolean invert = gtk_toggle_button_get_active(fx->invert_check);
 
-	// Apply Filter
+	// Apply Filter (point FX only rebuild the layer's tables, no reload)
 	sdl_set_layer_alpha(layer_index, alpha);
 	sdl_set_layer_grayscale(layer_index, grayscale ? 1 : 0);
+	sdl_set_layer_invert(layer_index, invert ? 1 : 0);
+	sdl_set_layer_contrast(layer_index, contrast);
+	sdl_set_layer_threshold(layer_index, threshold);
     sdl_set_layer_speed(layer_index, speed);
     
     // Only play if frames exist or not loading
@@ -95,8 +98,8 @@ void on_fx_button_clicked(GtkButton *button, gpointer user_data) {
 	GtkWidget *threshold_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
 	gtk_widget_set_hexpand(threshold_box, TRUE);
 	GtkWidget *threshold_label = gtk_label_new("Threshold");
-	GtkWidget *threshold_spin = gtk_spin_button_new_with_range(0, 255, 1);
-	gtk_spin_button_set_value(GTK_SPIN_BUTTON(threshold_spin), 128);
+	GtkWidget *threshold_spin = gtk_spin_button_new_with_range(0, 255, 1);   // 0 = off
+	gtk_spin_button_set_value(GTK_SPIN_BUTTON(threshold_spin), sdl_get_layer_threshold(layer_index));
 	gtk_box_pack_start(GTK_BOX(threshold_box), threshold_label, FALSE, FALSE, 5);
 	gtk_box_pack_start(GTK_BOX(threshold_box), threshold_spin, TRUE, TRUE, 0);
 
@@ -105,7 +108,7 @@ void on_fx_button_clicked(GtkButton *button, gpointer user_data) {
 	gtk_widget_set_hexpand(contrast_box, TRUE);
 	GtkWidget *contrast_label = gtk_label_new("Contrast");
 	GtkWidget *contrast_spin = gtk_spin_button_new_with_range(0.2, 3.0, 0.05);
-	gtk_spin_button_set_value(GTK_SPIN_BUTTON(contrast_spin), 1.0);
+	gtk_spin_button_set_value(GTK_SPIN_BUTTON(contrast_spin), sdl_get_layer_contrast(layer_index));
 	gtk_box_pack_start(GTK_BOX(contrast_box), contrast_label, FALSE, FALSE, 5);
 	gtk_box_pack_start(GTK_BOX(contrast_box), contrast_spin, TRUE, TRUE, 0);
 
@@ -132,7 +135,7 @@ void on_fx_button_clicked(GtkButton *button, gpointer user_data) {
 	gtk_widget_set_hexpand(invert_box, TRUE);
 	GtkWidget *invert_label = gtk_label_new("Invert");
 	GtkWidget *invert_check = gtk_check_button_new();
-	gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(invert_check), FALSE);
+	gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(invert_check), sdl_is_layer_inverted(layer_index));
 	gtk_box_pack_start(GTK_BOX(invert_box), invert_label, FALSE, FALSE, 5);
 	gtk_box_pack_start(GTK_BOX(invert_box), invert_check, TRUE, TRUE, 0);
 
@@ -1,5 +1,9 @@
 #include "modal_load_video.h"
 #include "../utils/accessor.h"
+#include "../media/decoder.h"
+#include "../media/media_info.h"
+#include "../media/ingest_cache.h"
+#include <SDL2/SDL_image.h>
 
 guint estimation_timeout_id = 0;
 
@@ -16,8 +20,16 @@ void update_export_estimation(VideoInfoLabels *labels)
     if (!filename || !*filename)
         return;
 
+    // Cache only: the probe runs off the UI thread when the file is dropped
+    MediaInfo info;
+    if (!media_info_lookup(filename, &info)) {
+        gtk_label_set_text(labels->estimated_frames_nb, "--");
+        gtk_label_set_text(labels->estimated_size, "--");
+        return;
+    }
+
     guint fps = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(labels->fps_spin));
-    guint dur_seconds = get_duration_in_seconds(filename);
+    guint dur_seconds = (guint)(info.duration + 0.5);
     guint est_frames = fps * dur_seconds;
 
     gchar buf[32];
@@ -32,15 +44,11 @@ void update_export_estimation(VideoInfoLabels *labels)
     else if (g_strcmp0(scale_text, "360p") == 0) export_width = 640;
 
     // Original resolution
-    gchar *res_str = get_resolution(filename);
-    int orig_w = 0, orig_h = 0;
-
-    if (res_str && sscanf(res_str, "%d x %d", &orig_w, &orig_h) == 2) {
-    } else {
+    int orig_w = info.width, orig_h = info.height;
+    if (orig_w <= 0 || orig_h <= 0) {
         orig_w = export_width;
         orig_h = (int)(export_width * 9.0 / 16.0);
     }
-    g_free(res_str);
 
     // Preserve aspect ratio
     int export_h = (int)((double)export_width * orig_h / orig_w);
@@ -331,6 +339,34 @@ void on_scale_combo_changed(GtkComboBox *combo, gpointer user_data) {
 }
 
 // Drag-and-drop callback
+// Fill the info labels once the probe of `path` is done
+static void on_media_info_ready(const char *path, const MediaInfo *info, gpointer user_data)
+{
+    VideoInfoLabels *labels = (VideoInfoLabels *)user_data;
+
+    // Skip if the modal was closed or another file was dropped meanwhile
+    gboolean current = gtk_widget_get_parent(GTK_WIDGET(labels->filename)) != NULL &&
+                       g_strcmp0(gtk_label_get_text(labels->filename), path) == 0;
+
+    if (current) {
+        gchar *res = info->valid ? g_strdup_printf("%dx%d", info->width, info->height) : g_strdup("--x--");
+        gtk_label_set_text(labels->resolution, res);
+        g_free(res);
+
+        gchar *fps = info->fps > 0 ? g_strdup_printf("%d", (int)info->fps) : g_strdup("--");
+        gtk_label_set_text(labels->fps, fps);
+        g_free(fps);
+
+        gchar *dur = get_duration(path);
+        gtk_label_set_text(labels->duration, dur);
+        g_free(dur);
+
+        update_export_estimation(labels);
+    }
+
+    g_object_unref(labels->filename);
+}
+
 void on_drag_data_received(GtkWidget *widget,
                            GdkDragContext *context,
                            gint x, gint y,
@@ -356,23 +392,17 @@ void on_drag_data_received(GtkWidget *widget,
                     // Update infos
                     gtk_label_set_text(labels->filename, filename);
             
-                    gchar *res = get_resolution(filename);
-                    gtk_label_set_text(labels->resolution, res);
-                    g_free(res);
-
-                    gchar *fps = get_fps(filename);
-                    gtk_label_set_text(labels->fps, fps);
-                    g_free(fps);
-
-                    gchar *dur = get_duration(filename);
-                    gtk_label_set_text(labels->duration, dur);
-                    g_free(dur);
+                    // Probed off the UI thread, labels filled when ready
+                    gtk_label_set_text(labels->resolution, "...");
+                    gtk_label_set_text(labels->fps, "...");
+                    gtk_label_set_text(labels->duration, "...");
 
                     gchar *size = get_filesize(filename);
                     gtk_label_set_text(labels->filesize, size);
                     g_free(size);
 
-                    update_export_estimation((VideoInfoLabels *)user_data);
+                    g_object_ref(labels->filename);
+                    media_info_probe_async(filename, on_media_info_ready, labels);
 
                 } else {
                     add_main_log(g_strdup_printf("[WARN] Ignored non-MP4 file: %s", filename));
@@ -467,50 +497,56 @@ gpointer export_thread_func(gpointer data) {
         g_error_free(err);
     }
 
-    // Total duration in milliseconds
-    guint64 total_ms = get_duration_in_seconds(ctx->file_path) * 1000;
-
-    // FFmpeg command
-    char cmd[1024];
-    snprintf(cmd, sizeof(cmd),
-             "ffmpeg -i \"%s\" -vf scale=%d:-1,fps=%d \"%s/frame_%%05d.png\" -progress pipe:1 -nostats -loglevel info",
-             ctx->file_path,
-             ctx->resolution,
-             ctx->fps,
-             folder_abs
-    );
-    
-    FILE *pipe = popen(cmd, "r");
-    if (!pipe) {
-    	add_main_log("[ERROR] Failed to run FFmpeg!");
+    // Same clip at the same settings: reuse the earlier ingest
+    gchar *cache_key = ingest_cache_key(ctx->file_path, ctx->fps, ctx->resolution);
+    if (ingest_cache_restore(cache_key, ctx->file_path, folder_abs)) {
+        add_main_log(g_strdup_printf("[CACHE] Reused ingest of %s", ctx->file_path));
+        g_free(cache_key);
         g_free(folder_abs);
-        return NULL;
+        goto done;
     }
 
-    char line[256];
-    while (fgets(line, sizeof(line), pipe)) {
-        line[strcspn(line, "\r\n")] = 0; // trim newline
-
-        if (g_str_has_prefix(line, "out_time_ms=")) {
-            guint64 out_ms = 0;
-            sscanf(line + strlen("out_time_ms="), "%lu", &out_ms);
-            double fraction = (double)out_ms / (double)(total_ms * 1000);
-            if (fraction > 1.0) fraction = 1.0;
-
-            char text[16];
-            snprintf(text, sizeof(text), "%d%%", (int)(fraction * 100));
+    // Probe the clip: the layer streams frames on demand, ingest only needs
+    // the first one (thumbnail) and the frame count
+    Decoder *dec = decoder_open(ctx->file_path, ctx->fps, ctx->resolution);
+    if (!dec) {
+        add_main_log(g_strdup_printf("[ERROR] Failed to open video: %s", ctx->file_path));
+        g_free(cache_key);
+        g_free(folder_abs);
+        return NULL;
+    }
 
-            ProgressUpdate *upd = g_malloc(sizeof(ProgressUpdate));
-            upd->progress_bar = ctx->progress_bar;
-            upd->fraction = fraction;
-            upd->text = g_strdup(text);
-            g_idle_add(update_progress_cb, upd);
-        }
+    // Estimated from the container: readers stop at the real end of stream
+    SDL_Surface *first = NULL;
+    int ret = decoder_read_frame(dec, &first);
+    int frame_count = ret > 0 ? decoder_estimate_frame_count(dec) : 0;
+    decoder_close(dec);
+
+    if (first) {
+        gchar *preview = g_build_filename(folder_abs, DECODER_PREVIEW_NAME, NULL);
+        IMG_SavePNG(first, preview);
+        g_free(preview);
+        SDL_FreeSurface(first);
+    } else {
+        add_main_log(g_strdup_printf("[WARN] No frame decoded from %s", ctx->file_path));
     }
 
-    pclose(pipe);
+    // Manifest so the layer and the sequence bake can decode the same frames
+    DecoderManifest manifest = {
+        .source = ctx->file_path,
+        .fps = ctx->fps,
+        .width = ctx->resolution,
+        .frame_count = frame_count
+    };
+    if (decoder_write_manifest(folder_abs, &manifest) != 0)
+        add_main_log(g_strdup_printf("[ERROR] Failed to write %s in %s", DECODER_MANIFEST_NAME, folder_abs));
+    else if (frame_count > 0)
+        ingest_cache_store(cache_key, folder_abs);
+
+    g_free(cache_key);
     g_free(folder_abs);
 
+done:
     // Final progress update
     ProgressUpdate *upd = g_malloc(sizeof(ProgressUpdate));
     upd->progress_bar = ctx->progress_bar;
@@ -0,0 +1,215 @@
+/* Master clock and present pacing */
+#include "frame_clock.h"
+
+#include <math.h>
+
+#define NS_PER_SEC 1000000000ULL
+
+// Presents are summarized this often
+#define STATS_WINDOW_NS (60 * NS_PER_SEC)
+
+static struct {
+    Uint64   period_ns;       // display refresh period
+    gboolean vsync;           // SDL_RenderPresent blocks on the display
+    Uint64   target_ns;       // scheduled present of the frame being drawn
+    Uint64   last_ns;         // last actual present (0 = none yet)
+    gboolean log_stats;       // PULSRR_HUD: print each stats window
+
+    // Stats since the last reset
+    Uint64   window_ns;
+    int      frames;
+    int      missed;          // intervals over 1.5 periods
+    double   interval_sum;    // ms
+    double   interval_sq;
+    double   late_sum;        // ms past the scheduled slot
+    double   late_max;
+} clk = { .period_ns = NS_PER_SEC / 60 };
+
+Uint64 frame_clock_now_ns(void)
+{
+    static Uint64 freq = 0;
+    if (!freq) freq = SDL_GetPerformanceFrequency();
+
+    // Split to keep the product in 64 bits for long uptimes
+    Uint64 ticks = SDL_GetPerformanceCounter();
+    return ticks / freq * NS_PER_SEC + ticks % freq * NS_PER_SEC / freq;
+}
+
+static void sleep_until(Uint64 deadline_ns)
+{
+    Uint64 now = frame_clock_now_ns();
+    if (deadline_ns > now) g_usleep((deadline_ns - now) / 1000);
+}
+
+void frame_clock_init(SDL_Window *window, SDL_Renderer *renderer)
+{
+    SDL_DisplayMode mode;
+    int hz = 60;
+    if (window && SDL_GetWindowDisplayMode(window, &mode) == 0 && mode.refresh_rate > 0)
+        hz = mode.refresh_rate;
+    clk.period_ns = NS_PER_SEC / hz;
+
+    SDL_RendererInfo info;
+    clk.vsync = renderer && SDL_GetRendererInfo(renderer, &info) == 0 &&
+                (info.flags & SDL_RENDERER_PRESENTVSYNC);
+
+    clk.last_ns = 0;
+    clk.log_stats = g_getenv("PULSRR_HUD") != NULL;
+    frame_clock_reset_stats();
+    g_print("[CLOCK] Display %d Hz, vsync %s\n", hz, clk.vsync ? "on" : "off");
+}
+
+Uint64 frame_clock_begin_frame(void)
+{
+    Uint64 now = frame_clock_now_ns();
+    if (!clk.last_ns) {
+        clk.target_ns = now + clk.period_ns;
+        return clk.target_ns;
+    }
+
+    // Next slot after the last present; slots already gone are dropped
+    clk.target_ns = clk.last_ns + clk.period_ns;
+    if (clk.target_ns <= now)
+        clk.target_ns += ((now - clk.target_ns) / clk.period_ns + 1) * clk.period_ns;
+    return clk.target_ns;
+}
+
+void frame_clock_wait_slot(void)
+{
+    // Without vsync the clock itself holds the frame to its slot
+    if (!clk.vsync) sleep_until(clk.target_ns);
+}
+
+static void record_present(Uint64 now)
+{
+    double late = now > clk.target_ns ? (now - clk.target_ns) / 1e6 : 0.0;
+    clk.late_sum += late;
+    if (late > clk.late_max) clk.late_max = late;
+
+    if (clk.last_ns) {
+        double interval = (now - clk.last_ns) / 1e6;
+        clk.interval_sum += interval;
+        clk.interval_sq += interval * interval;
+        if (now - clk.last_ns > clk.period_ns * 3 / 2) clk.missed++;
+    }
+    clk.frames++;
+}
+
+void frame_clock_presented(void)
+{
+    Uint64 now = frame_clock_now_ns();
+
+    // Reported vsync that does not block (some X11 setups): pace by the clock
+    if (clk.vsync && now + clk.period_ns / 2 < clk.target_ns) {
+        sleep_until(clk.target_ns);
+        now = frame_clock_now_ns();
+    }
+
+    record_present(now);
+
+    // Without vsync slots stay on their grid, late wakeups do not shift it
+    clk.last_ns = clk.vsync || now > clk.target_ns + clk.period_ns ? now : clk.target_ns;
+
+    if (!clk.window_ns) clk.window_ns = now;
+    if (now - clk.window_ns >= STATS_WINDOW_NS) {
+        if (clk.log_stats) {
+            gchar *stats = frame_clock_stats_summary();
+            g_print("[CLOCK] %s\n", stats);
+            g_free(stats);
+        }
+        frame_clock_reset_stats();
+    }
+}
+
+void frame_clock_skip_frame(void)
+{
+    // Skipped slots count neither as presents nor as misses
+    sleep_until(clk.target_ns);
+    clk.last_ns = clk.target_ns;
+}
+
+void frame_clock_get_stats(FrameClockStats *stats)
+{
+    int intervals = clk.frames > 1 ? clk.frames - 1 : 0;
+    double mean = intervals ? clk.interval_sum / intervals : 0.0;
+    double var = intervals ? clk.interval_sq / intervals - mean * mean : 0.0;
+
+    stats->presents = clk.frames;
+    stats->missed = clk.missed;
+    stats->period_ms = clk.period_ns / 1e6;
+    stats->interval_ms = mean;
+    stats->jitter_ms = sqrt(MAX(var, 0.0));
+    stats->late_avg_ms = clk.frames ? clk.late_sum / clk.frames : 0.0;
+    stats->late_max_ms = clk.late_max;
+}
+
+gchar* frame_clock_stats_summary(void)
+{
+    FrameClockStats st;
+    frame_clock_get_stats(&st);
+
+    return g_strdup_printf("%d presents, interval %.3f ms (period %.3f), jitter %.3f ms, "
+                           "late avg %.3f / max %.3f ms, %d missed",
+                           st.presents, st.interval_ms, st.period_ms, st.jitter_ms,
+                           st.late_avg_ms, st.late_max_ms, st.missed);
+}
+
+void frame_clock_reset_stats(void)
+{
+    clk.window_ns = 0;
+    clk.frames = 0;
+    clk.missed = 0;
+    clk.interval_sum = 0.0;
+    clk.interval_sq = 0.0;
+    clk.late_sum = 0.0;
+    clk.late_max = 0.0;
+}
+
+// Time bases
+void frame_time_base_init(FrameTimeBase *tb, int num, int den, Uint64 now_ns)
+{
+    tb->num = num > 0 ? num : 1;
+    tb->den = den > 0 ? den : 1;
+    tb->speed = 1.0;
+    tb->running = TRUE;
+    tb->anchor_ns = now_ns;
+    tb->anchor_pos = 0.0;
+}
+
+double frame_time_base_position(const FrameTimeBase *tb, Uint64 now_ns)
+{
+    if (!tb->running || now_ns <= tb->anchor_ns) return tb->anchor_pos;
+
+    // Always measured from the anchor, never accumulated
+    double seconds = (double)(now_ns - tb->anchor_ns) / NS_PER_SEC;
+    return tb->anchor_pos + seconds * tb->speed * tb->num / tb->den;
+}
+
+static void re_anchor(FrameTimeBase *tb, Uint64 now_ns)
+{
+    tb->anchor_pos = frame_time_base_position(tb, now_ns);
+    tb->anchor_ns = now_ns;
+}
+
+void frame_time_base_set_speed(FrameTimeBase *tb, double speed, Uint64 now_ns)
+{
+    if (tb->speed == speed) return;
+    re_anchor(tb, now_ns);
+    tb->speed = speed;
+}
+
+void frame_time_base_set_running(FrameTimeBase *tb, gboolean running, Uint64 now_ns)
+{
+    if (tb->running == running) return;
+    re_anchor(tb, now_ns);
+    tb->running = running;
+}
+
+int frame_time_base_frame(const FrameTimeBase *tb, Uint64 now_ns, int count)
+{
+    if (count <= 0) return 0;
+
+    // The epsilon keeps exact cadences (30 fps on 60 Hz) from landing a hair short
+    double pos = floor(frame_time_base_position(tb, now_ns) + 1e-6);
+    return (int)fmod(pos, count);
+}
@@ -0,0 +1,56 @@
+#ifndef FRAME_CLOCK_H
+#define FRAME_CLOCK_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+// Master clock of the output. Every layer and the sequence pick their
+// frame from the time the output frame will be presented, so frame
+// selection never accumulates rounding and stays on the display cadence.
+
+// Monotonic nanoseconds (SDL_GetPerformanceCounter)
+Uint64 frame_clock_now_ns(void);
+
+// Present scheduling, render thread only
+void   frame_clock_init(SDL_Window *window, SDL_Renderer *renderer);
+Uint64 frame_clock_begin_frame(void);     // scheduled present time of this frame
+void   frame_clock_wait_slot(void);       // call right before SDL_RenderPresent
+void   frame_clock_presented(void);       // call right after SDL_RenderPresent
+void   frame_clock_skip_frame(void);      // nothing changed: sleep through this slot
+
+// Drift / jitter since the last reset (logged every minute with PULSRR_HUD)
+typedef struct {
+    int    presents;
+    int    missed;          // intervals over 1.5 refresh periods
+    double period_ms;       // display refresh
+    double interval_ms;     // mean present interval
+    double jitter_ms;       // its standard deviation
+    double late_avg_ms;     // past the scheduled slot
+    double late_max_ms;
+} FrameClockStats;
+
+void   frame_clock_get_stats(FrameClockStats *stats);
+gchar* frame_clock_stats_summary(void);
+void   frame_clock_reset_stats(void);
+
+// Rational time base of one source: `num / den` frames per second at
+// `speed`, anchored on the master clock. Speed changes and pauses re-anchor
+// so the position stays continuous.
+typedef struct {
+    int      num;
+    int      den;
+    double   speed;
+    gboolean running;
+    Uint64   anchor_ns;     // master time of `anchor_pos`
+    double   anchor_pos;    // position in frames
+} FrameTimeBase;
+
+void   frame_time_base_init(FrameTimeBase *tb, int num, int den, Uint64 now_ns);
+void   frame_time_base_set_speed(FrameTimeBase *tb, double speed, Uint64 now_ns);
+void   frame_time_base_set_running(FrameTimeBase *tb, gboolean running, Uint64 now_ns);
+double frame_time_base_position(const FrameTimeBase *tb, Uint64 now_ns);
+
+// Frame shown at `now_ns` in a loop of `count` frames
+int    frame_time_base_frame(const FrameTimeBase *tb, Uint64 now_ns, int count);
+
+#endif // FRAME_CLOCK_H
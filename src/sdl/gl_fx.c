@@ -0,0 +1,234 @@
+/* GL shader path for live layer FX */
+#include "gl_fx.h"
+
+#include <SDL2/SDL_opengl.h>
+
+// Every entry point goes through SDL_GL_GetProcAddress, no libGL link needed
+#define GL_FUNCS \
+    X(void,   glGetIntegerv,        (GLenum, GLint *)) \
+    X(GLboolean, glIsEnabled,       (GLenum)) \
+    X(void,   glEnable,             (GLenum)) \
+    X(void,   glDisable,            (GLenum)) \
+    X(void,   glBlendFuncSeparate,  (GLenum, GLenum, GLenum, GLenum)) \
+    X(void,   glBegin,              (GLenum)) \
+    X(void,   glEnd,                (void)) \
+    X(void,   glTexCoord2f,         (GLfloat, GLfloat)) \
+    X(void,   glVertex2f,           (GLfloat, GLfloat)) \
+    X(GLuint, glCreateShader,       (GLenum)) \
+    X(void,   glShaderSource,       (GLuint, GLsizei, const GLchar **, const GLint *)) \
+    X(void,   glCompileShader,      (GLuint)) \
+    X(void,   glGetShaderiv,        (GLuint, GLenum, GLint *)) \
+    X(void,   glGetShaderInfoLog,   (GLuint, GLsizei, GLsizei *, GLchar *)) \
+    X(void,   glDeleteShader,       (GLuint)) \
+    X(GLuint, glCreateProgram,      (void)) \
+    X(void,   glAttachShader,       (GLuint, GLuint)) \
+    X(void,   glLinkProgram,        (GLuint)) \
+    X(void,   glGetProgramiv,       (GLuint, GLenum, GLint *)) \
+    X(void,   glGetProgramInfoLog,  (GLuint, GLsizei, GLsizei *, GLchar *)) \
+    X(void,   glDeleteProgram,      (GLuint)) \
+    X(void,   glUseProgram,         (GLuint)) \
+    X(GLint,  glGetUniformLocation, (GLuint, const GLchar *)) \
+    X(void,   glUniform1i,          (GLint, GLint)) \
+    X(void,   glUniform1f,          (GLint, GLfloat))
+
+static struct {
+#define X(ret, name, args) ret (APIENTRY *name) args;
+    GL_FUNCS
+#undef X
+} gl;
+
+// SDL picks 2D or rectangle textures depending on the driver
+enum { PROGRAM_2D, PROGRAM_RECT, PROGRAM_COUNT };
+
+typedef struct {
+    GLuint id;
+    GLint  tex, gray, invert, contrast, threshold, alpha;
+} FxProgram;
+
+static FxProgram programs[PROGRAM_COUNT];
+static gboolean  ready = FALSE;
+
+// Both stages are prefixed with "#version 110" and the variant define
+static const char *vertex_src =
+    "varying vec2 uv;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = gl_Vertex;\n"
+    "    uv = gl_MultiTexCoord0.xy;\n"
+    "}\n";
+
+// Same order as fx_chain: luma, contrast, threshold, invert
+static const char *fragment_src =
+    "#ifdef RECT\n"
+    "#extension GL_ARB_texture_rectangle : enable\n"
+    "uniform sampler2DRect tex;\n"
+    "#define SAMPLE(p) texture2DRect(tex, p)\n"
+    "#else\n"
+    "uniform sampler2D tex;\n"
+    "#define SAMPLE(p) texture2D(tex, p)\n"
+    "#endif\n"
+    "uniform float gray, invert, contrast, threshold, alpha;\n"
+    "varying vec2 uv;\n"
+    "void main()\n"
+    "{\n"
+    "    vec4 c = SAMPLE(uv);\n"
+    "    vec3 rgb = c.rgb;\n"
+    "    if (gray > 0.5 || threshold > 0.0)\n"
+    "        rgb = vec3((rgb.r + rgb.g + rgb.b) / 3.0);\n"
+    "    rgb = clamp((rgb - 128.0 / 255.0) * contrast + 128.0 / 255.0, 0.0, 1.0);\n"
+    "    if (threshold > 0.0)\n"
+    "        rgb = step(vec3(threshold - 0.5 / 255.0), rgb);\n"
+    "    if (invert > 0.5)\n"
+    "        rgb = 1.0 - rgb;\n"
+    "    gl_FragColor = vec4(rgb, c.a * alpha);\n"
+    "}\n";
+
+void gl_fx_prepare(void)
+{
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl");
+    SDL_SetHint(SDL_HINT_VIDEO_FOREIGN_WINDOW_OPENGL, "1");
+}
+
+static gboolean load_functions(void)
+{
+#define X(ret, name, args) \
+    if (!(gl.name = SDL_GL_GetProcAddress(#name))) { \
+        g_printerr("[GL] Missing %s\n", #name); \
+        return FALSE; \
+    }
+    GL_FUNCS
+#undef X
+    return TRUE;
+}
+
+static GLuint compile_shader(GLenum type, const char *define)
+{
+    const GLchar *src[3] = {
+        "#version 110\n",
+        define,
+        type == GL_VERTEX_SHADER ? vertex_src : fragment_src
+    };
+
+    GLuint shader = gl.glCreateShader(type);
+    gl.glShaderSource(shader, 3, src, NULL);
+    gl.glCompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    gl.glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        GLchar log[512];
+        gl.glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        g_printerr("[GL] Shader compile failed: %s\n", log);
+        gl.glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static gboolean build_program(FxProgram *prog, const char *define)
+{
+    GLuint vs = compile_shader(GL_VERTEX_SHADER, define);
+    GLuint fs = compile_shader(GL_FRAGMENT_SHADER, define);
+    if (!vs || !fs) {
+        if (vs) gl.glDeleteShader(vs);
+        if (fs) gl.glDeleteShader(fs);
+        return FALSE;
+    }
+
+    prog->id = gl.glCreateProgram();
+    gl.glAttachShader(prog->id, vs);
+    gl.glAttachShader(prog->id, fs);
+    gl.glLinkProgram(prog->id);
+    gl.glDeleteShader(vs);
+    gl.glDeleteShader(fs);
+
+    GLint ok = GL_FALSE;
+    gl.glGetProgramiv(prog->id, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        GLchar log[512];
+        gl.glGetProgramInfoLog(prog->id, sizeof(log), NULL, log);
+        g_printerr("[GL] Program link failed: %s\n", log);
+        gl.glDeleteProgram(prog->id);
+        prog->id = 0;
+        return FALSE;
+    }
+
+    prog->tex       = gl.glGetUniformLocation(prog->id, "tex");
+    prog->gray      = gl.glGetUniformLocation(prog->id, "gray");
+    prog->invert    = gl.glGetUniformLocation(prog->id, "invert");
+    prog->contrast  = gl.glGetUniformLocation(prog->id, "contrast");
+    prog->threshold = gl.glGetUniformLocation(prog->id, "threshold");
+    prog->alpha     = gl.glGetUniformLocation(prog->id, "alpha");
+    return TRUE;
+}
+
+gboolean gl_fx_init(SDL_Renderer *renderer)
+{
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) != 0 || g_strcmp0(info.name, "opengl") != 0) {
+        g_printerr("[GL] Renderer is %s, shader FX disabled\n", info.name ? info.name : "unknown");
+        return FALSE;
+    }
+
+    if (!load_functions() ||
+        !build_program(&programs[PROGRAM_2D], "") ||
+        !build_program(&programs[PROGRAM_RECT], "#define RECT\n")) {
+        g_printerr("[GL] Shader FX unavailable, using precomputed FX\n");
+        return FALSE;
+    }
+
+    ready = TRUE;
+    g_print("[GL] Shader FX enabled\n");
+    return TRUE;
+}
+
+int gl_fx_draw(SDL_Renderer *renderer, SDL_Texture *texture, const FxParams *fx, Uint8 alpha)
+{
+    if (!ready || !texture) return -1;
+
+    // Queued SDL draws go first, then the texture is bound on SDL's context
+    SDL_RenderFlush(renderer);
+
+    float texw, texh;
+    if (SDL_GL_BindTexture(texture, &texw, &texh) != 0) return -1;
+
+    // Rectangle textures are addressed in texels
+    const FxProgram *prog = &programs[texw > 1.0f ? PROGRAM_RECT : PROGRAM_2D];
+
+    GLint program, src_rgb, dst_rgb, src_a, dst_a;
+    GLboolean blend = gl.glIsEnabled(GL_BLEND);
+    gl.glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    gl.glGetIntegerv(GL_BLEND_SRC_RGB, &src_rgb);
+    gl.glGetIntegerv(GL_BLEND_DST_RGB, &dst_rgb);
+    gl.glGetIntegerv(GL_BLEND_SRC_ALPHA, &src_a);
+    gl.glGetIntegerv(GL_BLEND_DST_ALPHA, &dst_a);
+
+    gl.glUseProgram(prog->id);
+    gl.glUniform1i(prog->tex, 0);
+    gl.glUniform1f(prog->gray, fx->grayscale ? 1.0f : 0.0f);
+    gl.glUniform1f(prog->invert, fx->invert ? 1.0f : 0.0f);
+    gl.glUniform1f(prog->contrast, (GLfloat)CLAMP(fx->contrast, 0.0, 8.0));
+    gl.glUniform1f(prog->threshold, CLAMP(fx->threshold, 0, 255) / 255.0f);
+    gl.glUniform1f(prog->alpha, alpha / 255.0f);
+
+    // Same blending as SDL_BLENDMODE_BLEND
+    gl.glEnable(GL_BLEND);
+    gl.glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Whole viewport in clip space, first texture row at the top. SDL keeps
+    // render targets bottom-up, so the quad is flipped while one is bound.
+    GLfloat top = SDL_GetRenderTarget(renderer) ? -1.0f : 1.0f;
+    gl.glBegin(GL_QUADS);
+    gl.glTexCoord2f(0.0f, 0.0f); gl.glVertex2f(-1.0f,  top);
+    gl.glTexCoord2f(texw, 0.0f); gl.glVertex2f( 1.0f,  top);
+    gl.glTexCoord2f(texw, texh); gl.glVertex2f( 1.0f, -top);
+    gl.glTexCoord2f(0.0f, texh); gl.glVertex2f(-1.0f, -top);
+    gl.glEnd();
+
+    // SDL caches its GL state: put everything back as it was
+    gl.glBlendFuncSeparate(src_rgb, dst_rgb, src_a, dst_a);
+    if (!blend) gl.glDisable(GL_BLEND);
+    gl.glUseProgram(program);
+    SDL_GL_UnbindTexture(texture);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef GL_FX_H
+#define GL_FX_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+#include "../media/fx_chain.h"
+
+// Optional shader path on SDL's "opengl" render driver (PULSRR_RENDERER=gl).
+// Live layers are drawn once from their base texture through a fragment
+// shader applying gray / invert / contrast / threshold / alpha, so FX need
+// no precomputed copies. Runs on Mesa llvmpipe (LIBGL_ALWAYS_SOFTWARE=1).
+
+// Call before the window and renderer are created
+void gl_fx_prepare(void);
+
+// FALSE when the renderer is not GL or the shaders do not build
+gboolean gl_fx_init(SDL_Renderer *renderer);
+
+// Draw `texture` over the whole viewport. SDL's GL state is restored.
+int gl_fx_draw(SDL_Renderer *renderer, SDL_Texture *texture, const FxParams *fx, Uint8 alpha);
+
+#endif // GL_FX_H
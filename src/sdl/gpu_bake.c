@@ -0,0 +1,300 @@
+/* Offscreen bake on the render thread */
+#include "gpu_bake.h"
+#include "render_thread.h"
+
+#define NS_PER_SEC 1000000000ULL
+
+// Frames read back but not taken yet (ARGB8888, ~8 MB each at 1080p)
+#define GPU_BAKE_WINDOW 16
+
+// Render time per tick: half a 60 Hz frame, the rest stays with the output
+#define GPU_BAKE_BUDGET_NS (8 * 1000000ULL)
+
+// Waiting consumers look at the cancel flag this often
+#define GPU_BAKE_POLL_US 50000
+
+typedef enum {
+    GPU_BAKE_PENDING,     // posted, not taken by the render thread yet
+    GPU_BAKE_RUNNING,
+    GPU_BAKE_DONE,        // render thread let go (finished, failed or stopped)
+} GpuBakeState;
+
+struct GpuBake {
+    // Read-only sources, owned by the caller
+    const Layer   *layers;
+    YuvFrame    ***yuv_frames;
+    int            width;
+    int            height;
+    int            frame_count;
+    int            fps;
+    gint          *cancel;
+
+    // Render thread only
+    SDL_Texture   *targets[2];
+    TexturePool   *pools[MAX_LAYERS];
+    SDL_Surface   *scratch[MAX_LAYERS];   // YUV frames converted for upload
+    int            next;                  // next frame to draw
+    int            pending;               // drawn, not read back (-1 = none)
+
+    // Shared with the consumers
+    GMutex         lock;
+    GCond          changed;
+    GpuBakeState   state;
+    gboolean       failed;
+    gboolean       stop;
+    int            base;                  // oldest frame not taken
+    gboolean      *taken;                 // per output frame
+    SDL_Surface   *slots[GPU_BAKE_WINDOW];
+    int            slot_frame[GPU_BAKE_WINDOW];
+};
+
+// The bake being drawn (render thread only)
+static GpuBake *active = NULL;
+
+static void bake_finish(GpuBake *bake, gboolean failed)
+{
+    for (int i = 0; i < 2; i++)
+        if (bake->targets[i]) SDL_DestroyTexture(bake->targets[i]);
+    for (int l = 0; l < MAX_LAYERS; l++) {
+        texture_pool_free(bake->pools[l]);
+        SDL_FreeSurface(bake->scratch[l]);
+        bake->pools[l] = NULL;
+        bake->scratch[l] = NULL;
+    }
+
+    g_mutex_lock(&bake->lock);
+    if (failed) bake->failed = TRUE;
+    bake->state = GPU_BAKE_DONE;
+    g_cond_broadcast(&bake->changed);
+    g_mutex_unlock(&bake->lock);
+
+    if (active == bake) active = NULL;
+}
+
+// Render thread
+static void bake_attach(gpointer data)
+{
+    GpuBake *bake = data;
+
+    gboolean ok = g_sdl.initialized && !active && SDL_RenderTargetSupported(g_sdl.renderer);
+    for (int i = 0; ok && i < 2; i++) {
+        bake->targets[i] = SDL_CreateTexture(g_sdl.renderer, SDL_PIXELFORMAT_ARGB8888,
+                                             SDL_TEXTUREACCESS_TARGET, bake->width, bake->height);
+        ok = bake->targets[i] != NULL;
+    }
+    if (!ok) {
+        g_printerr("[BAKE] No offscreen target %dx%d: %s\n", bake->width, bake->height, SDL_GetError());
+        bake_finish(bake, TRUE);
+        return;
+    }
+
+    for (int l = 0; l < MAX_LAYERS; l++)
+        if (bake->layers[l].frame_count > 0)
+            bake->pools[l] = texture_pool_new(g_sdl.renderer);
+
+    active = bake;
+    g_mutex_lock(&bake->lock);
+    bake->state = GPU_BAKE_RUNNING;
+    g_cond_broadcast(&bake->changed);
+    g_mutex_unlock(&bake->lock);
+}
+
+// Main thread: the only producer of the render queue
+static gboolean post_attach(gpointer data)
+{
+    render_thread_invoke(bake_attach, data);
+    return G_SOURCE_REMOVE;
+}
+
+GpuBake* gpu_bake_start(const Layer *layers, YuvFrame ***yuv_frames,
+                        int width, int height, int frame_count, int fps, gint *cancel)
+{
+    if (frame_count <= 0 || width <= 0 || height <= 0) return NULL;
+
+    GpuBake *bake = g_new0(GpuBake, 1);
+    bake->layers = layers;
+    bake->yuv_frames = yuv_frames;
+    bake->width = width;
+    bake->height = height;
+    bake->frame_count = frame_count;
+    bake->fps = fps > 0 ? fps : 25;
+    bake->cancel = cancel;
+    bake->pending = -1;
+    bake->taken = g_new0(gboolean, frame_count);
+    for (int i = 0; i < GPU_BAKE_WINDOW; i++) bake->slot_frame[i] = -1;
+    g_mutex_init(&bake->lock);
+    g_cond_init(&bake->changed);
+    bake->state = GPU_BAKE_PENDING;
+
+    g_idle_add(post_attach, bake);
+
+    g_mutex_lock(&bake->lock);
+    while (bake->state == GPU_BAKE_PENDING)
+        g_cond_wait(&bake->changed, &bake->lock);
+    gboolean running = bake->state == GPU_BAKE_RUNNING;
+    g_mutex_unlock(&bake->lock);
+
+    if (!running) {
+        gpu_bake_free(bake);
+        return NULL;
+    }
+    return bake;
+}
+
+// Texture of one layer at output frame `f`, uploaded through the live FX
+static SDL_Texture* bake_layer_texture(GpuBake *bake, int l, int f)
+{
+    const Layer *ly = &bake->layers[l];
+    Uint64 t = (Uint64)f * NS_PER_SEC / bake->fps;
+    int index = frame_time_base_frame(&ly->timebase, t, ly->frame_count);
+
+    // Frames uploaded for the GL shader are not reused once it is dropped
+    const FxChain *fx = sdl_layer_upload_fx(ly);
+    int serial = fx ? 1 : 0;
+    SDL_Texture *tex = texture_pool_lookup(bake->pools[l], index, serial);
+    if (tex) return tex;
+
+    SDL_Surface *src = ly->frames ? ly->frames[index] : NULL;
+    const YuvFrame *yuv = bake->yuv_frames[l] ? bake->yuv_frames[l][index] : NULL;
+    if (yuv) {
+        SDL_Surface *s = bake->scratch[l];
+        if (!s || s->w != yuv->width || s->h != yuv->height) {
+            SDL_FreeSurface(s);
+            s = bake->scratch[l] = SDL_CreateRGBSurfaceWithFormat(0, yuv->width, yuv->height,
+                                                                  32, SDL_PIXELFORMAT_ARGB8888);
+        }
+        if (s && yuv_frame_to_surface(yuv, s) == 0) src = s;
+    }
+    if (!src) return NULL;
+
+    return texture_pool_show_surface(bake->pools[l], index, serial, src, fx);
+}
+
+static void bake_draw(GpuBake *bake, int f)
+{
+    gboolean gl_fx = g_sdl.gl_fx;
+
+    SDL_SetRenderTarget(g_sdl.renderer, bake->targets[f % 2]);
+    SDL_SetRenderDrawColor(g_sdl.renderer, 0, 0, 0, 255);
+    SDL_RenderClear(g_sdl.renderer);
+
+    for (int l = 0; l < MAX_LAYERS; l++) {
+        if (bake->layers[l].frame_count <= 0) continue;
+        SDL_Texture *tex = bake_layer_texture(bake, l, f);
+        if (tex) sdl_draw_layer(tex, &bake->layers[l]);
+    }
+
+    SDL_SetRenderTarget(g_sdl.renderer, NULL);
+
+    // The GL shader dropped mid-frame: layers drawn after that lost their
+    // FX, redraw the frame with FX applied at upload before it is read back
+    if (gl_fx && !g_sdl.gl_fx) bake_draw(bake, f);
+}
+
+static gboolean bake_read_back(GpuBake *bake, int f)
+{
+    SDL_Surface *frame = SDL_CreateRGBSurfaceWithFormat(0, bake->width, bake->height,
+                                                        32, SDL_PIXELFORMAT_ARGB8888);
+    if (!frame) return FALSE;
+
+    SDL_SetRenderTarget(g_sdl.renderer, bake->targets[f % 2]);
+    int ret = SDL_RenderReadPixels(g_sdl.renderer, NULL, SDL_PIXELFORMAT_ARGB8888,
+                                   frame->pixels, frame->pitch);
+    SDL_SetRenderTarget(g_sdl.renderer, NULL);
+    if (ret != 0) {
+        g_printerr("[BAKE] Read back of frame %d failed: %s\n", f + 1, SDL_GetError());
+        SDL_FreeSurface(frame);
+        return FALSE;
+    }
+
+    g_mutex_lock(&bake->lock);
+    bake->slots[f % GPU_BAKE_WINDOW] = frame;
+    bake->slot_frame[f % GPU_BAKE_WINDOW] = f;
+    g_cond_broadcast(&bake->changed);
+    g_mutex_unlock(&bake->lock);
+    return TRUE;
+}
+
+gboolean gpu_bake_step(void)
+{
+    GpuBake *bake = active;
+    if (!bake) return FALSE;
+
+    gboolean worked = FALSE;
+    Uint64 deadline = frame_clock_now_ns() + GPU_BAKE_BUDGET_NS;
+
+    while (frame_clock_now_ns() < deadline) {
+        g_mutex_lock(&bake->lock);
+        gboolean stop = bake->stop || (bake->cancel && g_atomic_int_get(bake->cancel));
+        // One slot stays free for the frame still to be read back
+        gboolean room = bake->next < bake->frame_count &&
+                        bake->next < bake->base + GPU_BAKE_WINDOW - 1;
+        g_mutex_unlock(&bake->lock);
+
+        if (stop) {
+            bake_finish(bake, FALSE);
+            return TRUE;
+        }
+        if (!room && bake->pending < 0) break;
+
+        // Draw the next frame before reading the previous one back, so the
+        // read overlaps with queued drawing
+        if (room) bake_draw(bake, bake->next);
+        if (bake->pending >= 0 && !bake_read_back(bake, bake->pending)) {
+            bake_finish(bake, TRUE);
+            return TRUE;
+        }
+        bake->pending = room ? bake->next++ : -1;
+        worked = TRUE;
+
+        if (bake->next == bake->frame_count && bake->pending < 0) {
+            bake_finish(bake, FALSE);
+            break;
+        }
+    }
+    return worked;
+}
+
+SDL_Surface* gpu_bake_take(GpuBake *bake, int index)
+{
+    if (!bake || index < 0 || index >= bake->frame_count) return NULL;
+
+    int slot = index % GPU_BAKE_WINDOW;
+    g_mutex_lock(&bake->lock);
+    while (bake->slot_frame[slot] != index && !bake->failed && bake->state == GPU_BAKE_RUNNING) {
+        if (bake->cancel && g_atomic_int_get(bake->cancel)) break;
+        g_cond_wait_until(&bake->changed, &bake->lock,
+                          g_get_monotonic_time() + GPU_BAKE_POLL_US);
+    }
+
+    SDL_Surface *frame = NULL;
+    if (bake->slot_frame[slot] == index) {
+        frame = bake->slots[slot];
+        bake->slots[slot] = NULL;
+        bake->slot_frame[slot] = -1;
+        bake->taken[index] = TRUE;
+        while (bake->base < bake->frame_count && bake->taken[bake->base])
+            bake->base++;
+    }
+    g_mutex_unlock(&bake->lock);
+    return frame;
+}
+
+void gpu_bake_free(GpuBake *bake)
+{
+    if (!bake) return;
+
+    // The render thread notices on its next step
+    g_mutex_lock(&bake->lock);
+    bake->stop = TRUE;
+    while (bake->state != GPU_BAKE_DONE)
+        g_cond_wait(&bake->changed, &bake->lock);
+    g_mutex_unlock(&bake->lock);
+
+    for (int i = 0; i < GPU_BAKE_WINDOW; i++)
+        SDL_FreeSurface(bake->slots[i]);
+    g_free(bake->taken);
+    g_mutex_clear(&bake->lock);
+    g_cond_clear(&bake->changed);
+    g_free(bake);
+}
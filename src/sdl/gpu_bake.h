@@ -0,0 +1,35 @@
+#ifndef GPU_BAKE_H
+#define GPU_BAKE_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+#include "sdl.h"
+#include "../media/yuv_frame.h"
+
+// Offscreen bake on the render thread (PULSRR_BAKE=gpu). Each output
+// frame is drawn into a target texture with the live layer draw code and
+// read back for the frame sinks, alternating between two targets so one
+// frame is drawn while the previous one is read. Layer frames are picked
+// on their time base, as live mode does. The live output keeps its
+// cadence: the bake only gets a slice of every render tick.
+typedef struct GpuBake GpuBake;
+
+// Any thread but the render thread; waits until the render thread took
+// the bake. `layers` and `yuv_frames` (MAX_LAYERS each) must stay alive
+// and untouched until gpu_bake_free. Setting `*cancel` stops the bake.
+// NULL when no render target is available.
+GpuBake* gpu_bake_start(const Layer *layers, YuvFrame ***yuv_frames,
+                        int width, int height, int frame_count, int fps, gint *cancel);
+
+// Output frame `index` as an ARGB8888 surface the caller frees, waiting
+// for it. Frames are drawn a bounded window ahead of the oldest one not
+// taken yet. NULL if the bake failed or was cancelled.
+SDL_Surface* gpu_bake_take(GpuBake *bake, int index);
+
+// Stops the bake if still running and waits for the render thread
+void gpu_bake_free(GpuBake *bake);
+
+// Render thread: advance the running bake; FALSE when there was nothing to do
+gboolean gpu_bake_step(void);
+
+#endif // GPU_BAKE_H
@@ -0,0 +1,200 @@
+/* Render thread and its command queue */
+#include "render_thread.h"
+#include "sdl.h"
+#include "gpu_bake.h"
+
+// Power of two; the UI posts a handful of commands per frame at most
+#define RENDER_QUEUE_SIZE 256
+#define RENDER_QUEUE_MASK (RENDER_QUEUE_SIZE - 1)
+
+// Wait between polls while the output is not up
+#define RENDER_IDLE_US 16000
+
+// Single producer (GTK main thread), single consumer (render thread).
+// Each side only writes its own index; slots are published by the
+// atomic store of `head` after they are filled.
+static RenderCommand queue[RENDER_QUEUE_SIZE];
+static gint head = 0;   // next slot the producer fills
+static gint tail = 0;   // next slot the consumer reads
+
+static GThread *thread = NULL;
+static GThread *render_self = NULL;
+static gint     quit = 0;
+static guintptr target_xid = 0;
+static int      target_width = 0;
+static int      target_height = 0;
+
+static Layer* command_layer(const RenderCommand *cmd)
+{
+    if (cmd->layer < 0 || cmd->layer >= MAX_LAYERS) return NULL;
+    return g_sdl.layers[cmd->layer];
+}
+
+static void apply_command(const RenderCommand *cmd)
+{
+    Layer *ly = command_layer(cmd);
+
+    switch (cmd->type) {
+        case RENDER_CMD_LAYER_ALPHA:
+            if (ly) ly->alpha = (Uint8)cmd->ivalue;
+            break;
+
+        case RENDER_CMD_LAYER_SPEED:
+            if (!ly) break;
+            ly->speed = cmd->dvalue;
+            frame_time_base_set_speed(&ly->timebase, cmd->dvalue, frame_clock_now_ns());
+            break;
+
+        case RENDER_CMD_LAYER_GRAYSCALE:
+            if (!ly || ly->grayscale == cmd->ivalue) break;
+            ly->grayscale = cmd->ivalue;
+            sdl_update_layer_fx(ly);
+            break;
+
+        case RENDER_CMD_LAYER_INVERT:
+            if (!ly || ly->invert == cmd->ivalue) break;
+            ly->invert = cmd->ivalue;
+            sdl_update_layer_fx(ly);
+            break;
+
+        case RENDER_CMD_LAYER_CONTRAST:
+            if (!ly || ly->contrast == cmd->dvalue) break;
+            ly->contrast = cmd->dvalue;
+            sdl_update_layer_fx(ly);
+            break;
+
+        case RENDER_CMD_LAYER_THRESHOLD:
+            if (!ly || ly->threshold == cmd->ivalue) break;
+            ly->threshold = cmd->ivalue;
+            sdl_update_layer_fx(ly);
+            break;
+
+        case RENDER_CMD_SCREEN_MODE:
+            g_sdl.screen_mode = (ScreenMode)cmd->ivalue;
+            break;
+
+        case RENDER_CMD_RENDER_STATE:
+            g_sdl.render_state = (RenderState)cmd->ivalue;
+            break;
+
+        case RENDER_CMD_PLAYBACK_SPEED:
+            if (!g_sdl.sequence) break;
+            g_sdl.sequence->speed = cmd->dvalue;
+            frame_time_base_set_speed(&g_sdl.sequence->timebase, cmd->dvalue, frame_clock_now_ns());
+            break;
+
+        case RENDER_CMD_RESIZE:
+            sdl_resize(cmd->ivalue, cmd->ivalue2);
+            break;
+
+        case RENDER_CMD_INVOKE:
+            if (cmd->func) cmd->func(cmd->data);
+            break;
+    }
+
+    // Whatever changed, the cached composite is out of date
+    sdl_mark_dirty();
+}
+
+// Consumer side: apply everything posted so far, in order
+static void drain_commands(void)
+{
+    int t = g_atomic_int_get(&tail);
+    while (t != g_atomic_int_get(&head)) {
+        apply_command(&queue[t]);
+        t = (t + 1) & RENDER_QUEUE_MASK;
+        g_atomic_int_set(&tail, t);
+    }
+}
+
+static gpointer render_main(gpointer data)
+{
+    (void)data;
+    render_self = g_thread_self();
+
+    // On failure the loop still drains commands so layer state stays coherent
+    if (!sdl_init(target_xid, target_width, target_height))
+        add_main_log("[ERROR] SDL output could not be initialized");
+
+    // Presents are paced by the frame clock (vsync, or its own slots);
+    // an offscreen bake gets a slice of each tick
+    while (!g_atomic_int_get(&quit)) {
+        drain_commands();
+        gboolean drawn = sdl_draw_tick();
+        gboolean baked = gpu_bake_step();
+        if (!drawn && !baked)
+            g_usleep(RENDER_IDLE_US);
+    }
+
+    drain_commands();
+    return NULL;
+}
+
+void render_thread_start(guintptr xid, int width, int height)
+{
+    if (thread) {
+        RenderCommand cmd = { .type = RENDER_CMD_RESIZE, .ivalue = width, .ivalue2 = height };
+        render_thread_post(&cmd);
+        return;
+    }
+
+    target_xid = xid;
+    target_width = width;
+    target_height = height;
+    g_atomic_int_set(&quit, 0);
+    thread = g_thread_new("render", render_main, NULL);
+}
+
+void render_thread_stop(void)
+{
+    if (!thread) return;
+
+    g_atomic_int_set(&quit, 1);
+    g_thread_join(thread);
+    thread = NULL;
+    render_self = NULL;
+}
+
+gboolean render_thread_is_current(void)
+{
+    return render_self && g_thread_self() == render_self;
+}
+
+// Producer side
+void render_thread_post(const RenderCommand *cmd)
+{
+    // Nothing else touches render state before the thread exists, and the
+    // render thread itself applies its own changes directly
+    if (!thread || render_thread_is_current()) {
+        apply_command(cmd);
+        return;
+    }
+
+    int h = g_atomic_int_get(&head);
+    int next = (h + 1) & RENDER_QUEUE_MASK;
+
+    // Full queue: the render thread empties it within a frame
+    while (next == g_atomic_int_get(&tail))
+        g_usleep(1000);
+
+    queue[h] = *cmd;
+    g_atomic_int_set(&head, next);
+}
+
+void render_thread_set_int(RenderCommandType type, int layer, int value)
+{
+    RenderCommand cmd = { .type = type, .layer = layer, .ivalue = value };
+    render_thread_post(&cmd);
+}
+
+void render_thread_set_double(RenderCommandType type, int layer, double value)
+{
+    RenderCommand cmd = { .type = type, .layer = layer, .dvalue = value };
+    render_thread_post(&cmd);
+}
+
+void render_thread_invoke(RenderFunc func, gpointer data)
+{
+    RenderCommand cmd = { .type = RENDER_CMD_INVOKE, .func = func, .data = data };
+    render_thread_post(&cmd);
+}
@@ -0,0 +1,54 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <glib.h>
+
+// Rendering runs on its own thread, which owns the SDL window, renderer
+// and every texture. The GTK main thread never writes render state: it
+// posts commands through a lock-free single-producer queue, drained at
+// the start of each frame. Output keeps its pace whatever GTK is doing.
+
+typedef enum {
+    RENDER_CMD_LAYER_ALPHA,       // layer, ivalue
+    RENDER_CMD_LAYER_SPEED,       // layer, dvalue
+    RENDER_CMD_LAYER_GRAYSCALE,   // layer, ivalue
+    RENDER_CMD_LAYER_INVERT,      // layer, ivalue
+    RENDER_CMD_LAYER_CONTRAST,    // layer, dvalue
+    RENDER_CMD_LAYER_THRESHOLD,   // layer, ivalue
+    RENDER_CMD_SCREEN_MODE,       // ivalue
+    RENDER_CMD_RENDER_STATE,      // ivalue
+    RENDER_CMD_PLAYBACK_SPEED,    // dvalue
+    RENDER_CMD_RESIZE,            // ivalue x ivalue2
+    RENDER_CMD_INVOKE             // func(data)
+} RenderCommandType;
+
+typedef void (*RenderFunc)(gpointer data);
+
+typedef struct {
+    RenderCommandType type;
+    int        layer;
+    int        ivalue;
+    int        ivalue2;
+    double     dvalue;
+    RenderFunc func;
+    gpointer   data;
+} RenderCommand;
+
+// Main thread only. Starts SDL on the new thread for the X window `xid`.
+void render_thread_start(guintptr xid, int width, int height);
+void render_thread_stop(void);
+
+// Main thread only (single producer). Before the thread starts, commands
+// are applied on the spot.
+void render_thread_post(const RenderCommand *cmd);
+void render_thread_set_int(RenderCommandType type, int layer, int value);
+void render_thread_set_double(RenderCommandType type, int layer, double value);
+
+// Run `func(data)` on the render thread, e.g. to install or free media
+// holding textures
+void render_thread_invoke(RenderFunc func, gpointer data);
+
+// TRUE on the render thread
+gboolean render_thread_is_current(void);
+
+#endif // RENDER_THREAD_H
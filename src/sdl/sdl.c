@@ -1,6 +1,13 @@
 /* SDL engine */
 #include "sdl.h"
 #include "../utils/accessor.h"
+#include "../media/decoder.h"
+#include "../media/frame_ring.h"
+#include "../media/frame_pack.h"
+#include "../media/frame_loader.h"
+#include "gl_fx.h"
+#include "render_thread.h"
+#include "text_atlas.h"
 
 /* System & libraries */
 #include <SDL2/SDL.h>
@@ -14,6 +21,16 @@
 #include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <stdlib.h>
+
+// A streamed frame was not ready: compose again next frame
+static gboolean frame_pending = FALSE;
+
+// Unchanged output is shown again this often, in case the window was exposed
+#define REPAINT_INTERVAL_NS (500 * 1000000ULL)
+
+// Stats HUD refresh
+#define HUD_UPDATE_NS (250 * 1000000ULL)
 
 // Global SDL state
 SDL g_sdl = {
@@ -21,126 +38,138 @@ SDL g_sdl = {
     .renderer = NULL,
     .surface = NULL,
     .initialized = FALSE,
-    .draw_source_id = 0,
+    .dirty = 1,
     .screen_mode = LIVE_MODE
 };
 
 
-void sdl_clear_layer(guint8 layer_index)
+// Drop every frame, texture and decoder a layer holds
+static void layer_release_media(Layer *layer)
 {
-    if (layer_index >= MAX_LAYERS) {
-        add_main_log("[WARN] sdl_clear_layer: invalid layer index");
-        return;
-    }
-
-    Layer *layer = g_sdl.layers[layer_index];
-    if (!layer) {
-        // Already empty — nothing to do
-        return;
-    }
-
-    add_main_log(g_strdup_printf("[SDL] Clearing layer %u...", layer_index + 1));
-
-    // 1. Destroy all textures
-    if (layer->textures) {
-        for (int i = 0; i < layer->frame_count; i++) {
-            if (layer->textures[i]) {
-                SDL_DestroyTexture(layer->textures[i]);
-                layer->textures[i] = NULL;
-            }
-        }
-        free(layer->textures);
-        layer->textures = NULL;
+    // Workers write into the surface arrays until the loader is gone
+    if (layer->loader) {
+        frame_loader_cancel(layer->loader);
+        frame_loader_free(layer->loader);
+        layer->loader = NULL;
     }
+    layer->loaded_frames = 0;
 
-    if (layer->textures_gray) {
-        for (int i = 0; i < layer->frame_count; i++) {
-            if (layer->textures_gray[i]) {
-                SDL_DestroyTexture(layer->textures_gray[i]);
-                layer->textures_gray[i] = NULL;
-            }
-        }
-        free(layer->textures_gray);
-        layer->textures_gray = NULL;
-    }
-
-    // 2. Free surfaces (if you store them)
     if (layer->frames) {
-        for (int i = 0; i < layer->frame_count; i++) {
-            if (layer->frames[i]) {
-                SDL_FreeSurface(layer->frames[i]);
-                layer->frames[i] = NULL;
-            }
-        }
-        free(layer->frames);
+        for (int i = 0; i < layer->frame_count; i++)
+            if (layer->frames[i]) SDL_FreeSurface(layer->frames[i]);
+        g_free(layer->frames);
         layer->frames = NULL;
     }
 
-    if (layer->frames_gray) {
-        for (int i = 0; i < layer->frame_count; i++) {
-            if (layer->frames_gray[i]) {
-                SDL_FreeSurface(layer->frames_gray[i]);
-                layer->frames_gray[i] = NULL;
-            }
-        }
-        free(layer->frames_gray);
-        layer->frames_gray = NULL;
-    }
+    // Streaming source
+    frame_ring_free(layer->ring);
+    layer->ring = NULL;
+    texture_pool_free(layer->pool);
+    layer->pool = NULL;
+    layer->frame_count = 0;
+}
 
-    // 3. Free folder path
-    free(layer->frame_folder);
-    layer->frame_folder = NULL;
+// Runs on the render thread, which owns the layer's textures
+static void clear_layer_media(gpointer data)
+{
+    guint8 layer_index = GPOINTER_TO_UINT(data);
+    Layer *layer = g_sdl.layers[layer_index];
 
-    // 4. Reset all fields
+    // 1. Destroy textures, surfaces and streaming source
+    layer_release_media(layer);
+
+    // 2. Reset playback and FX fields (state is owned by the main thread)
     layer->frame_count = 0;
     layer->current_frame = 0;
-    layer->last_tick = 0;
     layer->speed = 1.0;
     layer->fps = 25;  // or your default
+    frame_time_base_init(&layer->timebase, layer->fps, 1, frame_clock_now_ns());
     layer->alpha = 255;
     layer->grayscale = 0;
+    layer->invert = 0;
+    layer->contrast = 1.0;
+    layer->threshold = 0;
+    sdl_update_layer_fx(layer);
     layer->blend_mode = SDL_BLENDMODE_BLEND;
     layer->width = 0;
     layer->height = 0;
-    layer->accumulated_delta = 0.0;
-    layer->state = LAYER_EMPTY;
 
     add_main_log(g_strdup_printf("[SDL] Layer %u fully cleared from memory", layer_index + 1));
 }
 
+void sdl_clear_layer(guint8 layer_index)
+{
+    if (layer_index >= MAX_LAYERS) {
+        add_main_log("[WARN] sdl_clear_layer: invalid layer index");
+        return;
+    }
+
+    Layer *layer = g_sdl.layers[layer_index];
+    if (!layer) {
+        // Already empty — nothing to do
+        return;
+    }
+
+    add_main_log(g_strdup_printf("[SDL] Clearing layer %u...", layer_index + 1));
+
+    // The render thread stops drawing it from its next frame on
+    g_atomic_int_set((gint *)&layer->state, LAYER_EMPTY);
+
+    free(layer->frame_folder);
+    layer->frame_folder = NULL;
+
+    render_thread_invoke(clear_layer_media, GUINT_TO_POINTER(layer_index));
+}
+
 void free_sequence(Sequence *seq) {
     if (!seq) return;
 
-    if (seq->textures) {
-        for (int i = 0; i < seq->frame_count; i++)
-            if (seq->textures[i]) SDL_DestroyTexture(seq->textures[i]);
-        g_free(seq->textures);
-    }
+    texture_pool_free(seq->pool);
 
     if (seq->frames) {
         for (int i = 0; i < seq->frame_count; i++)
             if (seq->frames[i]) SDL_FreeSurface(seq->frames[i]);
         g_free(seq->frames);
     }
-	seq->accumulated_delta = 0.0;
     g_free(seq->root_folder);
     g_free(seq);
 }
 
+// Runs on the render thread: swaps the sequence in, the old one goes
+static void install_sequence(gpointer data)
+{
+    Sequence *seq = data;
+
+    // Frames are copied into the pool as they are shown
+    if (seq->frame_count > 0)
+        seq->pool = texture_pool_new(g_sdl.renderer);
+    frame_time_base_init(&seq->timebase, seq->fps, 1, frame_clock_now_ns());
+    frame_time_base_set_speed(&seq->timebase, seq->speed, frame_clock_now_ns());
+
+    free_sequence(g_sdl.sequence);
+    g_sdl.sequence = seq;
+}
+
+// Main thread: the only producer of the render queue
+static gboolean post_sequence_install(gpointer data)
+{
+    render_thread_invoke(install_sequence, data);
+    return G_SOURCE_REMOVE;
+}
+
 Sequence* update_sequence_texture() {
     Sequence *seq = g_malloc0(sizeof(Sequence));
     seq->current_frame = 0;
-    seq->last_tick = SDL_GetTicks();
     seq->frame_count = 0;
     seq->frames = NULL;
-    seq->textures = NULL;
+    seq->pool = NULL;
     seq->speed = 1.0;              
-    seq->accumulated_delta = 0.0;
-    seq->last_tick = SDL_GetTicks();
+    seq->fps = 25;                 // bakes run at 25 fps; packs say so
 
     gchar *sequences_dir = "sequences";
     seq->root_folder = g_strdup(sequences_dir);
     GPtrArray *all_frames = g_ptr_array_new();
+    frame_codec_reset_stats();
 
     DIR *dir = opendir(sequences_dir);
     if (!dir) {
@@ -153,6 +182,36 @@ Sequence* update_sequence_texture() {
         if (entry->d_type != DT_DIR) continue;
         if (g_str_has_prefix(entry->d_name, "sequence_")) {
 
+            // Baked sequences live in a single pack
+            gchar *pack_path = g_build_filename(sequences_dir, entry->d_name, FRAME_PACK_NAME, NULL);
+            FramePack *pack = frame_pack_open(pack_path);
+            g_free(pack_path);
+            if (pack) {
+                int count = frame_pack_get_frame_count(pack);
+                if (frame_pack_get_fps(pack) > 0) seq->fps = frame_pack_get_fps(pack);
+                SDL_Surface **decoded = g_malloc0(sizeof(SDL_Surface*) * MAX(count, 1));
+
+                FrameLoader *loader = frame_loader_new();
+                for (int f = 0; f < count; f++)
+                    frame_loader_add_pack(loader, pack, f, &decoded[f]);
+                frame_loader_free(loader);
+
+                for (int f = 0; f < count; f++) {
+                    if (!decoded[f]) {
+                        g_printerr("[PLAYBACK] Failed to load frame %d of %s\n", f + 1, entry->d_name);
+                        continue;
+                    }
+                    g_ptr_array_add(all_frames, decoded[f]);
+                }
+                g_free(decoded);
+                gchar *stats = frame_codec_stats_summary(frame_pack_get_codec(pack));
+                g_print("[PLAYBACK] %s: %s\n", entry->d_name, stats);
+                g_free(stats);
+                frame_pack_close(pack);
+                continue;
+            }
+
+            // Legacy PNG folder
             gchar *mixed_path = g_build_filename(sequences_dir, entry->d_name, "mixed_frames", NULL);
             if (!g_file_test(mixed_path, G_FILE_TEST_IS_DIR)) {
                 g_printerr("[PLAYBACK] No mixed_frames in %s\n", entry->d_name);
@@ -191,23 +250,21 @@ Sequence* update_sequence_texture() {
     seq->frame_count = all_frames->len;
     if (seq->frame_count > 0) {
         seq->frames = g_malloc0(sizeof(SDL_Surface*) * seq->frame_count);
-        seq->textures = g_malloc0(sizeof(SDL_Texture*) * seq->frame_count);
-
-        for (int i = 0; i < seq->frame_count; i++) {
-            SDL_Surface *surf = g_ptr_array_index(all_frames, i);
-            seq->frames[i] = surf;
-            seq->textures[i] = SDL_CreateTextureFromSurface(g_sdl.renderer, surf);
-        }
+        for (int i = 0; i < seq->frame_count; i++)
+            seq->frames[i] = g_ptr_array_index(all_frames, i);
     }
 
     g_ptr_array_free(all_frames, TRUE);
-    g_sdl.sequence = seq;
+
+    // Decoded on the caller (the bake worker too), installed from the main loop
+    g_idle_add(post_sequence_install, seq);
     return seq;
 }
 
-// sdl.c — implementation
-void sdl_clear_all_sequences(void)
+// Runs on the render thread, which owns the sequence textures
+static void clear_sequence_media(gpointer data)
 {
+    (void)data;
     Sequence *seq = g_sdl.sequence;
     if (!seq) {
         add_main_log("[SDL] No sequences to clear");
@@ -217,16 +274,8 @@ void sdl_clear_all_sequences(void)
     add_main_log("[SDL] Clearing all sequences from memory...");
 
     // 1. Free textures
-    if (seq->textures) {
-        for (int i = 0; i < seq->frame_count; i++) {
-            if (seq->textures[i]) {
-                SDL_DestroyTexture(seq->textures[i]);
-                seq->textures[i] = NULL;
-            }
-        }
-        free(seq->textures);
-        seq->textures = NULL;
-    }
+    texture_pool_free(seq->pool);
+    seq->pool = NULL;
 
     // 2. Free surfaces
     if (seq->frames) {
@@ -247,15 +296,20 @@ void sdl_clear_all_sequences(void)
     // 4. Reset all fields
     seq->frame_count = 0;
     seq->current_frame = 0;
-    seq->last_tick = 0;
     seq->fps = 25;
     seq->speed = 1.0;
-    seq->accumulated_delta = 0.0;
+    frame_time_base_init(&seq->timebase, seq->fps, 1, frame_clock_now_ns());
 
     add_main_log("[SDL] All sequences cleared from memory");
 }
 
-void sdl_render_playback_mode(int advance_frames) {
+void sdl_clear_all_sequences(void)
+{
+    render_thread_invoke(clear_sequence_media, NULL);
+}
+
+// Draws the sequence frame due at `present_ns` on the master clock
+void sdl_render_playback_mode(int advance_frames, Uint64 present_ns) {
 
 	if (!sdl_has_sequence_texture()) {
             draw_centered_text("PLAYBACK MODE (No sequence loaded)");
@@ -266,14 +320,13 @@ void sdl_render_playback_mode(int advance_frames) {
     }
 
     Sequence *seq = g_sdl.sequence;
-    Uint32 now = SDL_GetTicks();
-    double frame_duration = 1000.0 / MASTER_FPS;
 
-    if (seq->current_frame >= seq->frame_count || seq->current_frame < 0) {
-        seq->current_frame = 0;
-    }
+    // A paused sequence holds its position on the clock
+    frame_time_base_set_running(&seq->timebase, advance_frames, present_ns);
+    seq->current_frame = frame_time_base_frame(&seq->timebase, present_ns, seq->frame_count);
 
-    SDL_Texture *tex = seq->textures[seq->current_frame];
+    SDL_Texture *tex = texture_pool_show_surface(seq->pool, seq->current_frame, 0,
+                                                 seq->frames[seq->current_frame], NULL);
     if (!tex) {
         g_printerr("[PLAYBACK] Texture %d is NULL\n", seq->current_frame);
         return;
@@ -281,160 +334,194 @@ void sdl_render_playback_mode(int advance_frames) {
 
     SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
     SDL_RenderCopy(g_sdl.renderer, tex, NULL, NULL);
+	
+    //g_print("[PLAYBACK] frame=%d/%d speed=%.2f\n",seq->current_frame, seq->frame_count, seq->speed);
+}
 
-    if (advance_frames) {
-        Uint32 elapsed = now - seq->last_tick;
-        double delta = (double)elapsed / frame_duration * seq->speed;
-
-        seq->accumulated_delta += delta;
-
-        while (seq->accumulated_delta >= 1.0) {
-            seq->current_frame = (seq->current_frame + 1) % seq->frame_count;
-            seq->accumulated_delta -= 1.0;
-        }
-
-        seq->last_tick = now;
+// Decode result of one claimed layer, built off the main thread
+typedef struct {
+    gchar        *folder;
+    FrameRing    *ring;
+    FrameLoader  *loader;
+    SDL_Surface **frames;
+    int           frame_count;
+    int           width;
+    int           height;
+    int           fps;        // ingest rate from the manifest (0 = unknown)
+} LayerLoad;
+
+typedef struct {
+    guint     reloaded;   // bit i = layer i claimed by this update
+    LayerLoad layers[4];
+} TextureUpdate;
+
+static void layer_load_discard(LayerLoad *ld)
+{
+    if (ld->loader) {
+        frame_loader_cancel(ld->loader);
+        frame_loader_free(ld->loader);
     }
-	
-    //g_print("[PLAYBACK] frame=%d/%d speed=%.2f accum=%.2f\n",seq->current_frame, seq->frame_count, seq->speed, seq->accumulated_delta);
+    for (int f = 0; ld->frames && f < ld->frame_count; f++)
+        if (ld->frames[f]) SDL_FreeSurface(ld->frames[f]);
+    g_free(ld->frames);
+    frame_ring_free(ld->ring);
+    g_free(ld->folder);
 }
 
-gboolean sdl_finalize_texture_update(gpointer data)
+// Runs on the render thread, which owns the layers' media
+static void install_texture_update(gpointer data)
 {
-    (void)data;
+    TextureUpdate *update = data;
 
     for (int i = 0; i < 4; i++) {
+        if (!(update->reloaded & (1u << i))) continue;
+
         Layer *ly = g_sdl.layers[i];
-        if (!ly) continue;
+        LayerLoad *ld = &update->layers[i];
 
-        if (ly->state != LAYER_MODIFIED)
+        // Modified or cleared again while decoding: this result is stale
+        if (!ly || g_atomic_int_get((gint *)&ly->state) != LAYER_LOADING) {
+            layer_load_discard(ld);
             continue;
-
-        /* --- clear old textures --- */
-        if (ly->textures) {
-            for (int f = 0; f < ly->frame_count; f++) {
-                if (ly->textures[f]) SDL_DestroyTexture(ly->textures[f]);
-                if (ly->textures_gray && ly->textures_gray[f])
-                    SDL_DestroyTexture(ly->textures_gray[f]);
-            }
-            g_free(ly->textures);
-            g_free(ly->textures_gray);
         }
 
-        ly->textures = g_malloc0(sizeof(SDL_Texture*) * ly->frame_count);
-        ly->textures_gray = g_malloc0(sizeof(SDL_Texture*) * ly->frame_count);
-
-        /* --- build textures --- */
-        for (int f = 0; f < ly->frame_count; f++) {
-            if (!ly->frames[f])
-                continue;
-
-            ly->textures[f] =
-                SDL_CreateTextureFromSurface(g_sdl.renderer, ly->frames[f]);
-
-            ly->textures_gray[f] =
-                SDL_CreateTextureFromSurface(g_sdl.renderer, ly->frames_gray[f]);
-
-            if (!ly->textures[f] || !ly->textures_gray[f]) {
-                g_printerr("[ERROR] Layer %d Frame %d texture creation failed\n", i, f + 1);
-            }
+        layer_release_media(ly);
+        // Frames play at the rate they were ingested at
+        Uint64 now = frame_clock_now_ns();
+        ly->current_frame = 0;
+        ly->fps = ld->fps > 0 ? ld->fps : MASTER_FPS;
+        frame_time_base_init(&ly->timebase, ly->fps, 1, now);
+        frame_time_base_set_speed(&ly->timebase, ly->speed, now);
+
+        /* --- streaming layer: frames come from the ring --- */
+        if (ld->ring) {
+            ly->ring = ld->ring;
+            ly->frame_count = ld->frame_count;
+            ly->width = ld->width;
+            ly->height = ld->height;
+            ly->pool = texture_pool_new(g_sdl.renderer);
         }
-
-        /* --- free surfaces --- */
-        for (int f = 0; f < ly->frame_count; f++) {
-            if (ly->frames[f]) SDL_FreeSurface(ly->frames[f]);
-            if (ly->frames_gray[f]) SDL_FreeSurface(ly->frames_gray[f]);
+        /* --- preloaded layer: surfaces stay in RAM as frames decode --- */
+        else if (ld->loader) {
+            ly->loader = ld->loader;
+            ly->frames = ld->frames;
+            ly->frame_count = ld->frame_count;
+            ly->pool = texture_pool_new(g_sdl.renderer);
         }
 
-        g_free(ly->frames);
-        g_free(ly->frames_gray);
-
-        ly->frames = NULL;
-        ly->frames_gray = NULL;
-
-        ly->current_frame = 0;
-        ly->last_tick = SDL_GetTicks();
-        ly->state = LAYER_UP_TO_DATE;
+        // The main thread may have claimed the layer again meanwhile
+        LayerState done = ly->pool ? LAYER_UP_TO_DATE : LAYER_EMPTY;
+        g_atomic_int_compare_and_exchange((gint *)&ly->state, LAYER_LOADING, done);
 
+        g_free(ld->folder);
     }
 
-    sdl_set_render_state(RENDER_STATE_PLAY);
+    // A paused output stays paused
+    if (g_sdl.render_state == RENDER_STATE_IDLE || g_sdl.render_state == RENDER_STATE_LOADING)
+        sdl_set_render_state(RENDER_STATE_PLAY);
 
-    return G_SOURCE_REMOVE;
+    g_free(update);
 }
 
-void* texture_update_thread(void *arg)
+// Main thread: hands decode results over to the render thread
+gboolean sdl_finalize_texture_update(gpointer data)
 {
-    (void)arg;
-	sdl_set_render_state(RENDER_STATE_LOADING);
+    render_thread_invoke(install_texture_update, data);
+    return G_SOURCE_REMOVE;
+}
 
+// Playback of loading layers wraps within the frames decoded in order;
+// the loader goes once every frame is in
+void sdl_poll_loaded_frames(void)
+{
     for (int i = 0; i < 4; i++) {
         Layer *ly = g_sdl.layers[i];
-        if (!ly) continue;
-		
-		// CLear surface
-        if (ly->frames) {
-            for (int f = 0; f < ly->frame_count; f++) {
-                if (ly->frames[f]) SDL_FreeSurface(ly->frames[f]);
-                if (ly->frames_gray && ly->frames_gray[f])
-                    SDL_FreeSurface(ly->frames_gray[f]);
-            }
-            g_free(ly->frames);
-            g_free(ly->frames_gray);
-        }
-
-        ly->frames = NULL;
-        ly->frames_gray = NULL;
-        ly->frame_count = 0;
-
-		// count frames
-		if (!ly->frame_folder) {
-			ly->state = LAYER_EMPTY;
-			continue;
-		}
-
-		int count = count_frames(ly->frame_folder);
-		if (count <= 0) {
-			ly->state = LAYER_EMPTY;
-			continue;
-		}
+        if (!ly || !ly->loader || ly->state != LAYER_UP_TO_DATE) continue;
 
+        ly->loaded_frames = frame_loader_get_ready(ly->loader);
+        if (ly->loaded_frames < ly->frame_count) continue;
 
-        ly->frames = g_malloc0(sizeof(SDL_Surface*) * count);
-        ly->frames_gray = g_malloc0(sizeof(SDL_Surface*) * count);
-        ly->frame_count = count;
+        frame_loader_free(ly->loader);
+        ly->loader = NULL;
+        add_main_log(g_strdup_printf("[SDL] Layer %d fully loaded (%d frames, %d streaming textures)",
+                                     i + 1, ly->frame_count, texture_pool_get_texture_count()));
+    }
+}
 
-        // Load surfaces
-        for (int f = 0; f < count; f++) {
-            char path[512];
-            snprintf(path, sizeof(path), "%s/frame_%05d.png", ly->frame_folder, f + 1);
+// Opens the sources of the claimed layers. Never touches the layers
+// themselves: results are installed by sdl_finalize_texture_update.
+void* texture_update_thread(void *arg)
+{
+    TextureUpdate *update = arg;
 
-            SDL_Surface *src = IMG_Load(path);
-            if (!src) {
-                g_printerr("[ERROR] Layer %d Frame %d load failed (%s)\n", i, f + 1, path);
+    for (int i = 0; i < 4; i++) {
+        LayerLoad *ld = &update->layers[i];
+        if (!(update->reloaded & (1u << i)) || !ld->folder) continue;
+
+        // Ingested clips are streamed through a bounded ring
+        DecoderManifest manifest;
+        if (decoder_read_manifest(ld->folder, &manifest) == 0) {
+            ld->fps = manifest.fps;
+            ld->ring = frame_ring_new(&manifest, sdl_get_frame_budget(), frame_format_get_default());
+            decoder_free_manifest(&manifest);
+
+            if (!ld->ring) {
+                g_printerr("[ERROR] Layer %d: cannot stream %s\n", i, ld->folder);
                 continue;
             }
 
-            ly->frames[f] = src;
-            ly->frames_gray[f] = create_grayscale_surface(src);
+            ld->frame_count = frame_ring_get_frame_count(ld->ring);
+            frame_ring_get_size(ld->ring, &ld->width, &ld->height);
+            continue;
+        }
+
+        // Legacy PNG folders are preloaded (FX are applied at upload), one
+        // loader per layer so each fills in frame order on its own
+        ld->loader = frame_loader_new();
+        ld->frame_count = decoder_queue_png_frames(ld->loader, ld->folder, &ld->frames);
+        if (ld->frame_count <= 0) {
+            frame_loader_free(ld->loader);
+            ld->loader = NULL;
+            ld->frame_count = 0;
         }
     }
 
-    g_idle_add(sdl_finalize_texture_update, NULL);
+    g_idle_add(sdl_finalize_texture_update, update);
 
     return NULL;
 }
 
-// Update text async
+// Update text async: claims the modified layers, the others keep playing
 void update_textures_async(void)
 {
+    TextureUpdate *update = g_new0(TextureUpdate, 1);
+
+    for (int i = 0; i < 4; i++) {
+        Layer *ly = g_sdl.layers[i];
+        if (!ly || ly->state != LAYER_MODIFIED) continue;
+
+        g_atomic_int_set((gint *)&ly->state, LAYER_LOADING);
+        update->reloaded |= 1u << i;
+        update->layers[i].folder = g_strdup(ly->frame_folder);
+    }
+
+    if (!update->reloaded) {
+        g_free(update);
+        return;
+    }
+
     pthread_t tid;
-    pthread_create(&tid, NULL, texture_update_thread, NULL);
+    pthread_create(&tid, NULL, texture_update_thread, update);
     pthread_detach(tid);
 }
 
 // Init layer
 void init_layers() {
+    // Streaming budget override, e.g. PULSRR_FRAME_BUDGET=240
+    const char *budget = g_getenv("PULSRR_FRAME_BUDGET");
+    if (budget && atoi(budget) > 0)
+        sdl_set_frame_budget(atoi(budget));
+
     for (int i = 0; i < 4; i++) {
         if (!g_sdl.layers[i]) {
             g_sdl.layers[i] = g_malloc0(sizeof(Layer));
@@ -443,86 +530,85 @@ void init_layers() {
         Layer *ly = g_sdl.layers[i];
         ly->state = LAYER_EMPTY;
         ly->frame_count = 0;
-        ly->textures = NULL;
-        ly->textures_gray = NULL;
         ly->grayscale = 0;
+        ly->invert = 0;
+        ly->contrast = 1.0;
+        ly->threshold = 0;
+        sdl_update_layer_fx(ly);
         ly->speed = 1;
 
         // Initial alpha default
         ly->alpha = (i == 0) ? 255 : 128;
 
         ly->current_frame = 0;
-        ly->last_tick = SDL_GetTicks();
-        ly->fps = 30;
+        ly->fps = MASTER_FPS;
+        frame_time_base_init(&ly->timebase, ly->fps, 1, frame_clock_now_ns());
     }
 }
 
 
-void draw_centered_text(const char *text)
+// Status text goes through the glyph atlas, built on first use
+static TextAtlas* status_font(void)
 {
-    static TTF_Font *font = NULL;
-    const AppPaths *paths = get_app_paths();
+    static TextAtlas *atlas = NULL;
+    static gboolean failed = FALSE;
+    if (atlas || failed) return atlas;
 
-    if (!font) {
-        char *font_path = g_build_filename(paths->media_dir, "DS-TERM.TTF", NULL);
-        if (!font_path) {
-            g_printerr("[SDL] Failed to build font path\n");
-            return;
-        }
-
-        font = TTF_OpenFont(font_path, 24);
-        g_free(font_path);  // ← FREE IT HERE
+    const AppPaths *paths = get_app_paths();
+    char *font_path = g_build_filename(paths->media_dir, "DS-TERM.TTF", NULL);
+    atlas = text_atlas_new(g_sdl.renderer, font_path, 24);
+    g_free(font_path);
 
-        if (!font) {
-            g_printerr("[SDL] Failed to load font: %s\n", TTF_GetError());
-            return;
-        }
-    }
+    failed = atlas == NULL;
+    return atlas;
+}
 
+void draw_centered_text(const char *text)
+{
     if (!text || !*text) return;  // Safety
 
-    SDL_Color green = {0x33, 0xFF, 0x33, 255};
-    SDL_Surface *surf = TTF_RenderUTF8_Blended(font, text, green);
-    if (!surf) {
-        g_printerr("[SDL] TTF_RenderUTF8_Blended failed: %s\n", TTF_GetError());
-        return;
-    }
-
-    SDL_Texture *tex = SDL_CreateTextureFromSurface(g_sdl.renderer, surf);
-    SDL_FreeSurface(surf);
-
-    if (!tex) {
-        g_printerr("[SDL] SDL_CreateTextureFromSurface failed: %s\n", SDL_GetError());
-        return;
-    }
+    TextAtlas *atlas = status_font();
+    if (!atlas) return;
 
-    int tex_w, tex_h;
-    SDL_QueryTexture(tex, NULL, NULL, &tex_w, &tex_h);
+    int text_w, text_h;
+    text_atlas_measure(atlas, text, &text_w, &text_h);
 
     int win_w, win_h;
     SDL_GetRendererOutputSize(g_sdl.renderer, &win_w, &win_h);
 
-    SDL_Rect dst = {
-        .x = (win_w - tex_w) / 2,
-        .y = (win_h - tex_h) / 2,
-        .w = tex_w,
-        .h = tex_h
-    };
+    SDL_Color green = {0x33, 0xFF, 0x33, 255};
+    text_atlas_draw(atlas, text, (win_w - text_w) / 2, (win_h - text_h) / 2, green);
+}
 
-    SDL_RenderCopy(g_sdl.renderer, tex, NULL, &dst);
-    SDL_DestroyTexture(tex);  // Good — you already do this
+// Frame clock stats in a corner (PULSRR_HUD=1); the text changes a few
+// times a second so the atlas serves it from its layout cache
+static void draw_stats_hud(Uint64 present_ns)
+{
+    static char text[128] = "";
+    static Uint64 updated_ns = 0;
+
+    TextAtlas *atlas = status_font();
+    if (!atlas) return;
+
+    if (!text[0] || present_ns - updated_ns >= HUD_UPDATE_NS) {
+        FrameClockStats st;
+        frame_clock_get_stats(&st);
+        g_snprintf(text, sizeof(text), "%.2f ms +-%.2f  late %.2f  missed %d  tex %d",
+                   st.interval_ms, st.jitter_ms, st.late_avg_ms, st.missed,
+                   texture_pool_get_texture_count());
+        updated_ns = present_ns;
+    }
+
+    SDL_Color green = {0x33, 0xFF, 0x33, 255};
+    text_atlas_draw(atlas, text, 8, 8, green);
 }
-// SDL init
-int sdl_init(GtkWidget *widget)
+
+// SDL init, on the render thread
+int sdl_init(guintptr xid, int width, int height)
 {
     if (g_sdl.initialized)
         return 1;
 
-    if (!gtk_widget_get_realized(widget)) {
-        g_printerr("[SDL] Widget not realized\n");
-        return 0;
-    }
-
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         g_printerr("[SDL] SDL_Init failed: %s\n", SDL_GetError());
         return 0;
@@ -533,10 +619,10 @@ int sdl_init(GtkWidget *widget)
         return 0;
     }
 
-    GdkWindow *gdk_window = gtk_widget_get_window(widget);
-    Window xid = GDK_WINDOW_XID(gdk_window);
+    gboolean want_gl = g_strcmp0(g_getenv("PULSRR_RENDERER"), "gl") == 0;
+    if (want_gl) gl_fx_prepare();
 
-    g_sdl.window = SDL_CreateWindowFrom((void *)(uintptr_t)xid);
+    g_sdl.window = SDL_CreateWindowFrom((void *)xid);
     if (!g_sdl.window) {
         g_printerr("[SDL] CreateWindowFrom failed: %s\n", SDL_GetError());
         return 0;
@@ -555,43 +641,119 @@ int sdl_init(GtkWidget *widget)
 
     SDL_SetRenderDrawBlendMode(g_sdl.renderer, SDL_BLENDMODE_BLEND);
 
+    // Falls back to precomputed FX when the GL path is unavailable
+    if (want_gl) g_sdl.gl_fx = gl_fx_init(g_sdl.renderer);
+
+    frame_clock_init(g_sdl.window, g_sdl.renderer);
+    g_sdl.hud = g_getenv("PULSRR_HUD") != NULL;
+
     g_sdl.initialized = TRUE;
+    sdl_resize(width, height);
     //g_print("[SDL] Initialized (renderer mode)\n");
 
     return 1;
 }
 
-// Apply grayscale
-SDL_Surface* create_grayscale_surface(SDL_Surface *src) {
-    if (!src) return NULL;
+// Match the output to the GTK drawing area, on the render thread
+void sdl_resize(int width, int height)
+{
+    if (!g_sdl.initialized || width <= 0 || height <= 0)
+        return;
 
-    SDL_Surface *gray = SDL_ConvertSurface(src, src->format, 0);
-    if (!gray) return NULL;
+    SDL_SetWindowSize(g_sdl.window, width, height);
+    SDL_RenderSetLogicalSize(g_sdl.renderer, width, height);
+}
 
-    SDL_LockSurface(gray);
-    Uint8 *pixels = (Uint8 *)gray->pixels;
-    int pitch = gray->pitch;
+static FxParams layer_fx_params(const Layer *ly)
+{
+    FxParams params = { ly->grayscale, ly->invert, ly->contrast, ly->threshold };
+    return params;
+}
 
-    for (int y = 0; y < gray->h; y++) {
-        Uint8 *row = pixels + y * pitch;
-        for (int x = 0; x < gray->w; x++) {
-            Uint8 *p = row + x * gray->format->BytesPerPixel;
-            Uint8 r, g, b;
-            SDL_GetRGB(*(Uint32 *)p, gray->format, &r, &g, &b);
-            Uint8 v = (r + g + b) / 3;
-            *(Uint32 *)p = SDL_MapRGB(gray->format, v, v, v);
-        }
+// Recompile the FX tables; a streamed layer re-uploads its current frame
+void sdl_update_layer_fx(Layer *ly)
+{
+    FxParams params = layer_fx_params(ly);
+    fx_chain_compile(&ly->fx, &params);
+    ly->fx_serial++;
+}
+
+// FX applied while a frame is uploaded; on the GL path the shader applies
+// them and frames go up untouched
+const FxChain* sdl_layer_upload_fx(const Layer *ly)
+{
+    return g_sdl.gl_fx || ly->fx.identity ? NULL : &ly->fx;
+}
+
+// The shader failed: FX go back to upload time. Frames uploaded for the
+// shader carry no FX, so every layer re-uploads its shown frame.
+static void gl_fx_fallback(void)
+{
+    g_printerr("[SDL] GL FX draw failed, applying FX at upload: %s\n", SDL_GetError());
+    g_sdl.gl_fx = FALSE;
+    for (int i = 0; i < MAX_LAYERS; i++)
+        if (g_sdl.layers[i]) g_sdl.layers[i]->fx_serial++;
+    sdl_mark_dirty();
+}
+
+// Draw a layer texture over the viewport with its FX and alpha
+void sdl_draw_layer(SDL_Texture *tex, const Layer *ly)
+{
+    FxParams params = layer_fx_params(ly);
+    if (g_sdl.gl_fx) {
+        if (gl_fx_draw(g_sdl.renderer, tex, &params, ly->alpha) == 0) return;
+        gl_fx_fallback();
     }
 
-    SDL_UnlockSurface(gray);
-    return gray;
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureAlphaMod(tex, ly->alpha);
+    SDL_RenderCopy(g_sdl.renderer, tex, NULL, NULL);
 }
 
-// Render draw live
-void sdl_render_live_mode(int advance_frames) {
+// Texture showing the current frame of a layer, copied into its pool on
+// frame or FX change. A streamed frame not decoded yet keeps the last one
+// up and leaves the output frame pending.
+static SDL_Texture* layer_texture(Layer *ly)
+{
+    int f = ly->current_frame;
+    int serial = g_sdl.gl_fx ? 0 : ly->fx_serial;
+    const FxChain *fx = sdl_layer_upload_fx(ly);
+
+    if (!ly->ring)
+        return texture_pool_show_surface(ly->pool, f, serial, ly->frames[f], fx);
+
+    SDL_Texture *tex = texture_pool_lookup(ly->pool, f, serial);
+    if (tex) return tex;
+
+    // Untouched YUV420 frames go up as planes for the GPU to convert
+    gboolean planar = frame_ring_get_format(ly->ring) == FRAME_FORMAT_YUV420 && !fx && !g_sdl.gl_fx;
+    Uint32 format = planar ? SDL_PIXELFORMAT_IYUV : SDL_PIXELFORMAT_ARGB8888;
+    SDL_Texture *back = texture_pool_back(ly->pool, format, ly->width, ly->height);
+    if (back && frame_ring_upload(ly->ring, f, back, fx) > 0) {
+        texture_pool_present(ly->pool, f, serial);
+        return back;
+    }
+    frame_pending = TRUE;
+    return texture_pool_front(ly->pool);
+}
+
+// Frames a layer loops over right now (0 = not drawn)
+static int layer_playable(const Layer *ly)
+{
+    if (!ly || ly->state != LAYER_UP_TO_DATE || ly->frame_count <= 0) return 0;
+    if ((!ly->frames && !ly->ring) || !ly->pool) return 0;
+
+    // Preloaded layers play within their decoded prefix while loading
+    int playable = ly->ring ? ly->frame_count : ly->loaded_frames;
+    if (playable < MIN(LAYER_PLAYABLE_FRAMES, ly->frame_count)) return 0;
+    return playable;
+}
+
+// Render draw live, returns the number of layers drawn. Each layer shows
+// the frame due at `present_ns` on the master clock.
+int sdl_render_live_mode(int advance_frames, Uint64 present_ns) {
     static int error_logged[4] = {0, 0, 0, 0};
-    Uint32 now = SDL_GetTicks();
-    double frame_duration = 1000.0 / MASTER_FPS;  // Time per frame in ms
+    int drawn = 0;
     
     if (!sdl_has_live_texture()) {
             draw_centered_text("LIVE MODE (No frames loaded)");
@@ -599,39 +761,39 @@ void sdl_render_live_mode(int advance_frames) {
 
     for (int i = 0; i < 4; i++) {
         Layer *ly = g_sdl.layers[i];
-        if (!ly || ly->state != LAYER_UP_TO_DATE || ly->frame_count <= 0 || !ly->textures) continue;
-
-        if (ly->current_frame >= ly->frame_count || ly->current_frame < 0) ly->current_frame = 0;
+        int playable = layer_playable(ly);
+        if (!playable) continue;
+
+        // A paused layer holds its position on the clock
+        frame_time_base_set_running(&ly->timebase, advance_frames, present_ns);
+        ly->current_frame = frame_time_base_frame(&ly->timebase, present_ns, playable);
+
+        // Move the prefetch window before asking for the frame, or a slow
+        // first decode leaves the playhead outside it for good
+        if (ly->ring) {
+            frame_ring_set_playhead(ly->ring, ly->current_frame, ly->speed);
+            ly->frame_count = frame_ring_get_frame_count(ly->ring);
+        }
 
-        SDL_Texture *tex = ly->grayscale ? ly->textures_gray[ly->current_frame] : ly->textures[ly->current_frame];
+        SDL_Texture *tex = layer_texture(ly);
         if (!tex) {
-            if (!error_logged[i]) {
-                g_printerr("[LIVE] Layer %d texture[%d] is NULL\n", i, ly->current_frame);
+            // Streaming layers simply wait for their first frame
+            if (ly->ring) frame_pending = TRUE;
+            if (!ly->ring && !error_logged[i]) {
+                g_printerr("[LIVE] Layer %d frame %d cannot be shown\n", i, ly->current_frame);
                 error_logged[i] = 1;
             }
             continue;
         }
         error_logged[i] = 0;
 
-        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
-        SDL_SetTextureAlphaMod(tex, ly->alpha);
-        SDL_RenderCopy(g_sdl.renderer, tex, NULL, NULL);
-
-        if (advance_frames) {
-            Uint32 elapsed = now - ly->last_tick;
-            double delta = (double)elapsed / frame_duration * ly->speed;
-            ly->accumulated_delta += delta;
-
-            while (ly->accumulated_delta >= 1.0) {
-                ly->current_frame = (ly->current_frame + 1) % ly->frame_count;
-                ly->accumulated_delta -= 1.0;
-            }
-
-            ly->last_tick = now;
-        }
+        sdl_draw_layer(tex, ly);
+        drawn++;
 
-        //g_print("[LIVE] Layer %d: frame=%d/%d alpha=%d grayscale=%d speed=%.2f accum=%.2f\n",i, ly->current_frame, ly->frame_count, ly->alpha, ly->grayscale, ly->speed, ly->accumulated_delta);
+        //g_print("[LIVE] Layer %d: frame=%d/%d alpha=%d grayscale=%d speed=%.2f\n",i, ly->current_frame, ly->frame_count, ly->alpha, ly->grayscale, ly->speed);
     }
+
+    return drawn;
 }
 
 // Returns true if at least one live layer has frames loaded TO BE REPLACED
@@ -641,8 +803,8 @@ bool sdl_has_live_texture(void)
         Layer *layer = g_sdl.layers[i];
         if (!layer) continue;
 
-        // Only count layers that have textures loaded
-        if (layer->textures && layer->frame_count > 0) {
+        // Only count layers that have textures loaded or streamed
+        if ((layer->frames || layer->ring) && layer->frame_count > 0) {
             return true;
         }
     }
@@ -655,44 +817,104 @@ bool sdl_has_sequence_texture(void)
     Sequence *seq = g_sdl.sequence;
     if (!seq) return false;
 
-    if (seq->textures && seq->frame_count > 0) {
+    if (seq->frames && seq->pool && seq->frame_count > 0) {
         return true;
     }
 
     return false;
 }
 
-// Main draw loop
-gboolean sdl_draw_tick(gpointer data)
+// What an output frame shows; an unchanged key means an unchanged picture
+typedef struct {
+    int screen_mode;
+    int render_state;
+    int progress;                // loading percent, live mode
+    int frames[MAX_LAYERS];      // frame due per layer (-1 = not drawn)
+    int seq_frame;
+} SceneKey;
+
+static SceneKey last_key;
+static Uint64   last_shown_ns = 0;
+
+static void scene_key(SceneKey *key, Uint64 present_ns)
 {
-    (void)data;
+    memset(key, 0, sizeof(*key));
+    key->screen_mode = g_sdl.screen_mode;
+    key->render_state = g_sdl.render_state;
+    key->seq_frame = -1;
+    for (int i = 0; i < MAX_LAYERS; i++) key->frames[i] = -1;
+
+    if (g_sdl.render_state == RENDER_STATE_IDLE) return;
+
+    if (g_sdl.screen_mode == LIVE_MODE) {
+        key->progress = (int)(sdl_get_load_progress() * 100);
+        for (int i = 0; i < MAX_LAYERS; i++) {
+            Layer *ly = g_sdl.layers[i];
+            int playable = layer_playable(ly);
+            if (playable) key->frames[i] = frame_time_base_frame(&ly->timebase, present_ns, playable);
+        }
+        return;
+    }
 
-    if (!g_sdl.initialized || !g_sdl.renderer)
-        return TRUE;
+    Sequence *seq = g_sdl.sequence;
+    if (g_sdl.render_state != RENDER_STATE_LOADING && seq && seq->frame_count > 0)
+        key->seq_frame = frame_time_base_frame(&seq->timebase, present_ns, seq->frame_count);
+}
+
+// Render target the output is composed into (NULL = compose on screen)
+static SDL_Texture* composite_target(void)
+{
+    int w, h, tw, th;
+    SDL_GetRendererOutputSize(g_sdl.renderer, &w, &h);
+
+    if (g_sdl.composite) {
+        SDL_QueryTexture(g_sdl.composite, NULL, NULL, &tw, &th);
+        if (tw == w && th == h) return g_sdl.composite;
+        SDL_DestroyTexture(g_sdl.composite);
+        g_sdl.composite = NULL;
+    }
 
+    if (!SDL_RenderTargetSupported(g_sdl.renderer) || w <= 0 || h <= 0) return NULL;
+
+    g_sdl.composite = SDL_CreateTexture(g_sdl.renderer, SDL_PIXELFORMAT_ARGB8888,
+                                        SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!g_sdl.composite)
+        g_printerr("[SDL] Composite target %dx%d failed: %s\n", w, h, SDL_GetError());
+    return g_sdl.composite;
+}
+
+// Draw the current mode into whatever target is bound
+static void compose_frame(Uint64 present_ns)
+{
     // Clear background once
     SDL_SetRenderDrawColor(g_sdl.renderer, 18, 18, 18, 255);
     SDL_RenderClear(g_sdl.renderer);
 
 	if (g_sdl.screen_mode == LIVE_MODE) {
-        
+        int drawn = 0;
+
 		switch (g_sdl.render_state) {
 		
 			case RENDER_STATE_IDLE:
 				break;
 		
 		    case RENDER_STATE_LOADING:
-		        draw_centered_text("LOADING FRAMES...");
-		        break;
-
 		    case RENDER_STATE_PLAY:
-		        sdl_render_live_mode(1);
+		        drawn = sdl_render_live_mode(1, present_ns);
 		        break;
 
 		    case RENDER_STATE_PAUSE:
-		        sdl_render_live_mode(0);
+		        drawn = sdl_render_live_mode(0, present_ns);
 		        break;
 		}
+
+		// Progress only while nothing is playable yet
+		double progress = sdl_get_load_progress();
+		if (progress < 1.0 && drawn == 0) {
+		    gchar *text = g_strdup_printf("LOADING FRAMES... %d%%", (int)(progress * 100));
+		    draw_centered_text(text);
+		    g_free(text);
+		}
 		
 		if (!sdl_has_live_texture() && g_sdl.render_state == RENDER_STATE_IDLE) {
             draw_centered_text("LIVE MODE (No frames loaded)");
@@ -710,11 +932,11 @@ gboolean sdl_draw_tick(gpointer data)
 		        break;
 
 		    case RENDER_STATE_PLAY:
-		        sdl_render_playback_mode(1);
+		        sdl_render_playback_mode(1, present_ns);
 		        break;
 
 		    case RENDER_STATE_PAUSE:
-		        sdl_render_playback_mode(0);
+		        sdl_render_playback_mode(0, present_ns);
 		        break;
 		}
 		
@@ -724,19 +946,75 @@ gboolean sdl_draw_tick(gpointer data)
 
 	}
 
-    // Present once per tick
+}
+
+// Flag the next frame for a full compose (any thread)
+void sdl_mark_dirty(void)
+{
+    g_atomic_int_set(&g_sdl.dirty, 1);
+}
+
+// One output frame, run by the render thread. FALSE when nothing was presented.
+// Unchanged frames are not composed again: the present is skipped, and the
+// cached composite is shown now and then to repair the window.
+gboolean sdl_draw_tick(void)
+{
+    if (!g_sdl.initialized || !g_sdl.renderer)
+        return FALSE;
+
+    // Everything drawn below is due when this frame reaches the display
+    Uint64 present_ns = frame_clock_begin_frame();
+
+    // Layers still loading become playable frame by frame
+    sdl_poll_loaded_frames();
+
+    SceneKey key;
+    scene_key(&key, present_ns);
+    gboolean dirty = g_atomic_int_compare_and_exchange(&g_sdl.dirty, 1, 0);
+    gboolean same = !dirty && !frame_pending && memcmp(&key, &last_key, sizeof(key)) == 0;
+
+    // The HUD keeps presenting, over the cached composite
+    if (same && !g_sdl.hud && present_ns - last_shown_ns < REPAINT_INTERVAL_NS) {
+        frame_clock_skip_frame();
+        return TRUE;
+    }
+
+    if (same && g_sdl.composite) {
+        SDL_RenderCopy(g_sdl.renderer, g_sdl.composite, NULL, NULL);
+    } else {
+        frame_pending = FALSE;
+        SDL_Texture *target = composite_target();
+        if (target) SDL_SetRenderTarget(g_sdl.renderer, target);
+
+        compose_frame(present_ns);
+
+        if (target) {
+            SDL_SetRenderTarget(g_sdl.renderer, NULL);
+            SDL_RenderCopy(g_sdl.renderer, target, NULL, NULL);
+        }
+        last_key = key;
+    }
+
+    // Drawn over the composite, never into it
+    if (g_sdl.hud) draw_stats_hud(present_ns);
+
+    // Present once per tick, on the slot the frame was drawn for
+    frame_clock_wait_slot();
     SDL_RenderPresent(g_sdl.renderer);
+    frame_clock_presented();
+    last_shown_ns = present_ns;
 
     return TRUE;
 }
 
-// Embed SDL in GTK
+// Embed SDL in GTK: the render thread takes the window over
 int sdl_embed_in_gtk(GtkWidget *widget)
 {
     //g_print("[SDL] embed called\n");
-	sdl_set_render_state(RENDER_STATE_IDLE);
-    if (!sdl_init(widget))
+    if (!gtk_widget_get_realized(widget)) {
+        g_printerr("[SDL] Widget not realized\n");
         return 0;
+    }
 
     int w = gtk_widget_get_allocated_width(widget);
     int h = gtk_widget_get_allocated_height(widget);
@@ -744,15 +1022,17 @@ int sdl_embed_in_gtk(GtkWidget *widget)
     if (w <= 0 || h <= 0)
         return 0;
 
-    SDL_SetWindowSize(g_sdl.window, w, h);
-    SDL_RenderSetLogicalSize(g_sdl.renderer, w, h);
-    
-    init_layers();
+    GdkWindow *gdk_window = gtk_widget_get_window(widget);
+    Window xid = GDK_WINDOW_XID(gdk_window);
 
-    if (g_sdl.draw_source_id == 0) {
-        g_sdl.draw_source_id = g_timeout_add(16, sdl_draw_tick, NULL);
+    // Layers are set up before the render thread can see them
+    static gboolean layers_ready = FALSE;
+    if (!layers_ready) {
+        sdl_set_render_state(RENDER_STATE_IDLE);
+        init_layers();
+        layers_ready = TRUE;
     }
 
+    render_thread_start((guintptr)xid, w, h);
     return 1;
 }
-
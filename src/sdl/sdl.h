@@ -4,6 +4,11 @@
 #include <gtk/gtk.h>
 #include <SDL2/SDL.h>
 #include "../utils/utils.h"
+#include "../media/frame_ring.h"
+#include "../media/frame_loader.h"
+#include "../media/fx_chain.h"
+#include "texture_pool.h"
+#include "frame_clock.h"
 
 // Render & Layer States
 typedef enum {
@@ -21,7 +26,8 @@ typedef enum {
 typedef enum {
     LAYER_EMPTY,
     LAYER_UP_TO_DATE,
-    LAYER_MODIFIED
+    LAYER_MODIFIED,
+    LAYER_LOADING       // claimed by a running texture update
 } LayerState;
 
 // Core runtime
@@ -32,8 +38,12 @@ typedef struct {
     gboolean      initialized;
     RenderState   render_state;
     ScreenMode screen_mode;
-    guint         draw_source_id;
     pthread_mutex_t mutex;
+    int             frame_budget;   // frames per layer ring (0 = LAYER_FRAME_BUDGET)
+    gboolean        gl_fx;          // layer FX drawn by the GL shader (PULSRR_RENDERER=gl)
+    SDL_Texture    *composite;      // last composed frame (render target, NULL = unsupported)
+    gint            dirty;          // set on any change; the next frame is composed again
+    gboolean        hud;            // frame clock stats on screen (PULSRR_HUD=1)
     struct Layer    *layers[4];
     struct Sequence *sequence;
 } SDL;
@@ -43,21 +53,26 @@ typedef struct {
 typedef struct Layer {
     char *frame_folder;
     SDL_Surface **frames;
-    SDL_Surface **frames_gray;
-    SDL_Texture **textures;
-    SDL_Texture **textures_gray;
     int     current_frame;
     int     frame_count;
-    Uint32  last_tick;
+    FrameTimeBase timebase;   // playhead on the master clock, at `fps`
     double  speed;
     int     fps;
     Uint8   alpha;
     int     grayscale;
+    int     invert;
+    double  contrast;         // 1.0 = off
+    int     threshold;        // 0 = off
+    FxChain fx;               // compiled from the fields above
+    int     fx_serial;        // bumped on every FX change
     int     blend_mode;
     int     width;
     int     height;
     LayerState state;
-    double accumulated_delta;
+    FrameRing   *ring;            // streaming source (NULL = preloaded frames)
+    TexturePool *pool;            // streaming textures the shown frame is copied into
+    FrameLoader *loader;          // preloaded frames still decoding (NULL = done)
+    int          loaded_frames;   // decoded prefix; playback wraps within it
 } Layer;
 
 // Sequence specifications
@@ -65,28 +80,26 @@ typedef struct Sequence {
     char *root_folder;
     SDL_Surface **frames;
     int           frame_count;
-    SDL_Texture **textures;
+    TexturePool  *pool;
     int     current_frame;
-    Uint32  last_tick;
+    FrameTimeBase timebase;
     int     fps;
     double speed;
-    double accumulated_delta;
 } Sequence;
 
 extern SDL g_sdl;
 
-// SDL Core
-int sdl_init(GtkWidget *widget);
+// SDL Core (sdl_init, sdl_resize and sdl_draw_tick run on the render thread)
+int sdl_init(guintptr xid, int width, int height);
+void sdl_resize(int width, int height);
+gboolean sdl_draw_tick(void);
+void sdl_mark_dirty(void);
 int sdl_embed_in_gtk(GtkWidget *widget);
 
 // Text rendering
 void draw_centered_text(const char *text);
 
 // Update textures
-SDL_Surface* create_grayscale_surface(SDL_Surface *src);
-
-// Gray surface 
-SDL_Surface* create_grayscale_surface(SDL_Surface *src);
 void* texture_update_thread(void *arg);
 gboolean sdl_finalize_texture_update(gpointer data);
 void update_textures_async(void);
@@ -95,12 +108,16 @@ void update_textures_async(void);
 void init_layers();
 
 // Render Live
-void sdl_render_live_mode(int advance_frames);
+int sdl_render_live_mode(int advance_frames, Uint64 present_ns);
+void sdl_poll_loaded_frames(void);
+void sdl_update_layer_fx(Layer *ly);
+const FxChain* sdl_layer_upload_fx(const Layer *ly);
+void sdl_draw_layer(SDL_Texture *tex, const Layer *ly);   // also used by the GPU bake
 
 // Sequence
 void free_sequence(Sequence *seq);
 Sequence* update_sequence_texture();
-void sdl_render_playback_mode(int advance_frames);
+void sdl_render_playback_mode(int advance_frames, Uint64 present_ns);
 
 // Utils
 bool sdl_has_live_texture(void);
@@ -0,0 +1,198 @@
+/* Glyph atlas text */
+#include "text_atlas.h"
+
+#include <SDL2/SDL_ttf.h>
+#include <string.h>
+
+#define FIRST_GLYPH  32
+#define LAST_GLYPH   126
+#define GLYPH_COUNT  (LAST_GLYPH - FIRST_GLYPH + 1)
+#define ATLAS_WIDTH  512
+
+// Cached layouts; the cache starts over past this many distinct strings
+#define MAX_CACHED_RUNS 128
+
+typedef struct {
+    SDL_Rect src;       // in the atlas (w = 0: nothing to draw)
+    int      advance;
+} Glyph;
+
+// Quads of one string at the origin, 4 vertices per glyph
+typedef struct {
+    int        width;
+    int        quads;
+    SDL_Vertex verts[];
+} TextRun;
+
+struct TextAtlas {
+    SDL_Renderer *renderer;
+    SDL_Texture  *texture;
+    int           tex_w;
+    int           tex_h;
+    int           line_height;
+    Glyph         glyphs[GLYPH_COUNT];
+    GHashTable   *runs;       // text -> TextRun
+    GArray       *verts;      // SDL_Vertex scratch for the batch
+    GArray       *indices;    // int, 6 per quad, grown on demand
+};
+
+TextAtlas* text_atlas_new(SDL_Renderer *renderer, const char *font_path, int size)
+{
+    TTF_Font *font = TTF_OpenFont(font_path, size);
+    if (!font) {
+        g_printerr("[TEXT] Failed to load font: %s\n", TTF_GetError());
+        return NULL;
+    }
+
+    TextAtlas *atlas = g_new0(TextAtlas, 1);
+    atlas->renderer = renderer;
+    atlas->line_height = TTF_FontHeight(font);
+
+    // Rasterise every glyph once and shelf-pack them in rows
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface *rendered[GLYPH_COUNT] = {0};
+    int x = 0, y = 0;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        Uint16 ch = FIRST_GLYPH + i;
+        Glyph *g = &atlas->glyphs[i];
+        if (TTF_GlyphMetrics(font, ch, NULL, NULL, NULL, NULL, &g->advance) != 0)
+            g->advance = 0;
+
+        rendered[i] = TTF_RenderGlyph_Blended(font, ch, white);
+        if (!rendered[i]) continue;
+
+        int w = rendered[i]->w, h = rendered[i]->h;
+        if (x + w > ATLAS_WIDTH) {
+            x = 0;
+            y += atlas->line_height + 1;
+        }
+        g->src = (SDL_Rect){ x, y, w, h };
+        if (!g->advance) g->advance = w;
+        x += w + 1;   // gutter against filtering bleed
+    }
+    TTF_CloseFont(font);
+
+    atlas->tex_w = ATLAS_WIDTH;
+    atlas->tex_h = y + atlas->line_height + 1;
+    SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(0, atlas->tex_w, atlas->tex_h,
+                                                        32, SDL_PIXELFORMAT_ARGB8888);
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        if (!rendered[i]) continue;
+        if (sheet) {
+            // Copy coverage as is, not blended onto the transparent sheet
+            SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(rendered[i], NULL, sheet, &atlas->glyphs[i].src);
+        }
+        SDL_FreeSurface(rendered[i]);
+    }
+
+    if (sheet) {
+        atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+        SDL_FreeSurface(sheet);
+    }
+    if (!atlas->texture) {
+        g_printerr("[TEXT] Glyph atlas failed: %s\n", SDL_GetError());
+        text_atlas_free(atlas);
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+
+    atlas->runs = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    atlas->verts = g_array_new(FALSE, FALSE, sizeof(SDL_Vertex));
+    atlas->indices = g_array_new(FALSE, FALSE, sizeof(int));
+    return atlas;
+}
+
+void text_atlas_free(TextAtlas *atlas)
+{
+    if (!atlas) return;
+    if (atlas->texture) SDL_DestroyTexture(atlas->texture);
+    if (atlas->runs) g_hash_table_destroy(atlas->runs);
+    if (atlas->verts) g_array_free(atlas->verts, TRUE);
+    if (atlas->indices) g_array_free(atlas->indices, TRUE);
+    g_free(atlas);
+}
+
+static const Glyph* glyph_for(const TextAtlas *atlas, unsigned char ch)
+{
+    if (ch < FIRST_GLYPH || ch > LAST_GLYPH) ch = '?';
+    return &atlas->glyphs[ch - FIRST_GLYPH];
+}
+
+// Lay `text` out at the origin; `verts` holds 4 per byte
+static TextRun* build_run(const TextAtlas *atlas, const char *text)
+{
+    gsize len = strlen(text);
+    TextRun *run = g_malloc0(sizeof(TextRun) + sizeof(SDL_Vertex) * 4 * len);
+    float tw = atlas->tex_w, th = atlas->tex_h;
+    SDL_Color white = {255, 255, 255, 255};
+
+    int x = 0;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        // One '?' per UTF-8 sequence: continuation bytes are dropped
+        if ((*p & 0xC0) == 0x80) continue;
+
+        const Glyph *g = glyph_for(atlas, *p);
+        if (g->src.w > 0) {
+            SDL_Vertex *v = &run->verts[run->quads++ * 4];
+            float x0 = x, x1 = x + g->src.w, y1 = g->src.h;
+            float u0 = g->src.x / tw, u1 = (g->src.x + g->src.w) / tw;
+            float v0 = g->src.y / th, v1 = (g->src.y + g->src.h) / th;
+            v[0] = (SDL_Vertex){ { x0, 0 },  white, { u0, v0 } };
+            v[1] = (SDL_Vertex){ { x1, 0 },  white, { u1, v0 } };
+            v[2] = (SDL_Vertex){ { x1, y1 }, white, { u1, v1 } };
+            v[3] = (SDL_Vertex){ { x0, y1 }, white, { u0, v1 } };
+        }
+        x += g->advance;
+    }
+    run->width = x;
+    return run;
+}
+
+static const TextRun* cached_run(TextAtlas *atlas, const char *text)
+{
+    TextRun *run = g_hash_table_lookup(atlas->runs, text);
+    if (run) return run;
+
+    if (g_hash_table_size(atlas->runs) >= MAX_CACHED_RUNS)
+        g_hash_table_remove_all(atlas->runs);
+
+    run = build_run(atlas, text);
+    g_hash_table_insert(atlas->runs, g_strdup(text), run);
+    return run;
+}
+
+void text_atlas_measure(TextAtlas *atlas, const char *text, int *width, int *height)
+{
+    if (width)  *width  = atlas && text ? cached_run(atlas, text)->width : 0;
+    if (height) *height = atlas ? atlas->line_height : 0;
+}
+
+int text_atlas_draw(TextAtlas *atlas, const char *text, int x, int y, SDL_Color color)
+{
+    if (!atlas || !text || !*text) return 0;
+
+    const TextRun *run = cached_run(atlas, text);
+    if (!run->quads) return 0;
+
+    // Two triangles per quad, shared by every string
+    int have = atlas->indices->len / 6;
+    for (int q = have; q < run->quads; q++) {
+        int base = q * 4;
+        int quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+        g_array_append_vals(atlas->indices, quad, 6);
+    }
+
+    int count = run->quads * 4;
+    g_array_set_size(atlas->verts, count);
+    SDL_Vertex *v = (SDL_Vertex *)atlas->verts->data;
+    for (int i = 0; i < count; i++) {
+        v[i] = run->verts[i];
+        v[i].position.x += x;
+        v[i].position.y += y;
+        v[i].color = color;
+    }
+
+    return SDL_RenderGeometry(atlas->renderer, atlas->texture, v, count,
+                              (const int *)atlas->indices->data, run->quads * 6);
+}
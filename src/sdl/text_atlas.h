@@ -0,0 +1,22 @@
+#ifndef TEXT_ATLAS_H
+#define TEXT_ATLAS_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+
+// Glyphs of one font rasterised once into a texture; strings are drawn as
+// a single batch of textured quads (SDL_RenderGeometry). Layouts are
+// cached by string content, so repeated status text costs a vertex copy.
+// Covers printable ASCII; other characters are drawn as '?'.
+typedef struct TextAtlas TextAtlas;
+
+// NULL if the font cannot be opened
+TextAtlas* text_atlas_new(SDL_Renderer *renderer, const char *font_path, int size);
+void text_atlas_free(TextAtlas *atlas);
+
+void text_atlas_measure(TextAtlas *atlas, const char *text, int *width, int *height);
+
+// Top-left of the text at `x`, `y`
+int text_atlas_draw(TextAtlas *atlas, const char *text, int x, int y, SDL_Color color);
+
+#endif // TEXT_ATLAS_H
@@ -0,0 +1,132 @@
+/* Double-buffered streaming textures */
+#include "texture_pool.h"
+
+struct TexturePool {
+    SDL_Renderer *renderer;
+    SDL_Texture  *textures[TEXTURE_POOL_SIZE];
+    Uint32        format[TEXTURE_POOL_SIZE];
+    int           width[TEXTURE_POOL_SIZE];
+    int           height[TEXTURE_POOL_SIZE];
+    int           front;        // index of the texture on screen
+    int           shown_frame;  // frame held by the front texture (-1 = none)
+    int           shown_serial;
+};
+
+static int texture_count = 0;
+
+TexturePool* texture_pool_new(SDL_Renderer *renderer)
+{
+    TexturePool *pool = g_new0(TexturePool, 1);
+    pool->renderer = renderer;
+    pool->shown_frame = -1;
+    return pool;
+}
+
+void texture_pool_free(TexturePool *pool)
+{
+    if (!pool) return;
+    for (int i = 0; i < TEXTURE_POOL_SIZE; i++) {
+        if (!pool->textures[i]) continue;
+        SDL_DestroyTexture(pool->textures[i]);
+        texture_count--;
+    }
+    g_free(pool);
+}
+
+SDL_Texture* texture_pool_lookup(TexturePool *pool, int frame, int serial)
+{
+    if (!pool || pool->shown_frame < 0) return NULL;
+    if (pool->shown_frame != frame || pool->shown_serial != serial) return NULL;
+    return pool->textures[pool->front];
+}
+
+SDL_Texture* texture_pool_back(TexturePool *pool, Uint32 format, int width, int height)
+{
+    if (!pool || width <= 0 || height <= 0) return NULL;
+
+    int back = (pool->front + 1) % TEXTURE_POOL_SIZE;
+    if (pool->textures[back] && pool->format[back] == format &&
+        pool->width[back] == width && pool->height[back] == height)
+        return pool->textures[back];
+
+    if (pool->textures[back]) {
+        SDL_DestroyTexture(pool->textures[back]);
+        texture_count--;
+    }
+
+    pool->textures[back] = SDL_CreateTexture(pool->renderer, format,
+                                             SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (!pool->textures[back]) {
+        g_printerr("[POOL] Streaming texture %dx%d failed: %s\n", width, height, SDL_GetError());
+        return NULL;
+    }
+    texture_count++;
+
+    pool->format[back] = format;
+    pool->width[back] = width;
+    pool->height[back] = height;
+    return pool->textures[back];
+}
+
+void texture_pool_present(TexturePool *pool, int frame, int serial)
+{
+    if (!pool) return;
+    pool->front = (pool->front + 1) % TEXTURE_POOL_SIZE;
+    pool->shown_frame = frame;
+    pool->shown_serial = serial;
+}
+
+SDL_Texture* texture_pool_front(TexturePool *pool)
+{
+    if (!pool || pool->shown_frame < 0) return NULL;
+    return pool->textures[pool->front];
+}
+
+static int upload_surface(SDL_Texture *texture, SDL_Surface *surface, const FxChain *fx)
+{
+    gboolean argb = surface->format->format == SDL_PIXELFORMAT_ARGB8888;
+    if (argb && (!fx || fx->identity))
+        return SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch);
+
+    void *pixels;
+    int pitch;
+    if (SDL_LockTexture(texture, NULL, &pixels, &pitch) != 0) return -1;
+
+    int ret = 0;
+    if (argb) {
+        for (int y = 0; y < surface->h; y++) {
+            const Uint32 *in = (const Uint32 *)((const Uint8 *)surface->pixels + y * surface->pitch);
+            Uint32 *out = (Uint32 *)((Uint8 *)pixels + y * pitch);
+            fx_chain_apply_row(fx, in, out, surface->w);
+        }
+    } else {
+        // Other formats (legacy PNG sequences) are converted, without FX
+        ret = SDL_ConvertPixels(surface->w, surface->h, surface->format->format,
+                                surface->pixels, surface->pitch,
+                                SDL_PIXELFORMAT_ARGB8888, pixels, pitch);
+    }
+
+    SDL_UnlockTexture(texture);
+    return ret;
+}
+
+SDL_Texture* texture_pool_show_surface(TexturePool *pool, int frame, int serial,
+                                       SDL_Surface *surface, const FxChain *fx)
+{
+    SDL_Texture *tex = texture_pool_lookup(pool, frame, serial);
+    if (tex || !surface) return tex ? tex : texture_pool_front(pool);
+
+    SDL_Texture *back = texture_pool_back(pool, SDL_PIXELFORMAT_ARGB8888, surface->w, surface->h);
+    if (!back || upload_surface(back, surface, fx) != 0) {
+        g_printerr("[POOL] Frame %d upload failed: %s\n", frame, SDL_GetError());
+        return texture_pool_front(pool);
+    }
+
+    texture_pool_present(pool, frame, serial);
+    return back;
+}
+
+int texture_pool_get_texture_count(void)
+{
+    return texture_count;
+}
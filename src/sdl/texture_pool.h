@@ -0,0 +1,39 @@
+#ifndef TEXTURE_POOL_H
+#define TEXTURE_POOL_H
+
+#include <glib.h>
+#include <SDL2/SDL.h>
+#include "../media/fx_chain.h"
+
+// A fixed set of streaming textures reused for every frame of one
+// source (a layer or the playback sequence). Frames are copied in just
+// before they are drawn, always into the texture that is not on screen,
+// so VRAM depends on the number of sources, not on clip length.
+#define TEXTURE_POOL_SIZE 2
+
+typedef struct TexturePool TexturePool;
+
+TexturePool* texture_pool_new(SDL_Renderer *renderer);
+void texture_pool_free(TexturePool *pool);
+
+// Texture on screen if it already holds `frame` uploaded with `serial`
+SDL_Texture* texture_pool_lookup(TexturePool *pool, int frame, int serial);
+
+// Hidden texture for the next frame, (re)created at the given format / size
+// (SDL_PIXELFORMAT_ARGB8888, or SDL_PIXELFORMAT_IYUV for planar frames)
+SDL_Texture* texture_pool_back(TexturePool *pool, Uint32 format, int width, int height);
+
+// The back texture now holds `frame` / `serial` and goes on screen
+void texture_pool_present(TexturePool *pool, int frame, int serial);
+
+// Texture on screen, whatever it holds (NULL before the first present)
+SDL_Texture* texture_pool_front(TexturePool *pool);
+
+// Copy `surface` in through `fx` (NULL = as is) unless already shown
+SDL_Texture* texture_pool_show_surface(TexturePool *pool, int frame, int serial,
+                                       SDL_Surface *surface, const FxChain *fx);
+
+// Streaming textures alive across all pools
+int texture_pool_get_texture_count(void);
+
+#endif // TEXTURE_POOL_H
@@ -1,21 +1,29 @@
 #include "accessor.h"
 #include "../sdl/sdl.h"
+#include "../sdl/render_thread.h"
 #include "utils.h"
 
+// Setters run on the main thread and go through the render thread's
+// command queue; getters read the last applied value.
+
+// Only the UI changes the mode, so it answers from its own copy
+static ScreenMode requested_mode = LIVE_MODE;
+
 // Get current screen mode
 ScreenMode sdl_get_screen_mode(void)
 {
-    return g_sdl.screen_mode;
+    return requested_mode;
 }
 
 // Set screen mode and update UI if needed
 void sdl_set_screen_mode(ScreenMode mode)
 {
-    if (g_sdl.screen_mode == mode) {
+    if (requested_mode == mode) {
         return; // No change
     }
 
-    g_sdl.screen_mode = mode;
+    requested_mode = mode;
+    render_thread_set_int(RENDER_CMD_SCREEN_MODE, 0, mode);
     add_main_log(g_strdup_printf("[SDL] Screen mode changed to: %s",
                                  mode == LIVE_MODE ? "LIVE" : "PLAYBACK"));
 }
@@ -38,16 +46,15 @@ void sdl_set_layer_state(guint8 layer_index, LayerState new_state)
         }
     }
 
-    (*layer_ptr)->state = new_state;
+    g_atomic_int_set((gint *)&(*layer_ptr)->state, new_state);
+    sdl_mark_dirty();
 }
 
 // Playback
 void sdl_set_playback_speed(double speed) {
     if (speed < 0.01) speed = 0.01;  // prevent total freeze
-    if (g_sdl.sequence) {
-        g_sdl.sequence->speed = speed;
-        g_print("[PLAYBACK] Speed set to %.2f\n", speed);
-    }
+    render_thread_set_double(RENDER_CMD_PLAYBACK_SPEED, 0, speed);
+    g_print("[PLAYBACK] Speed set to %.2f\n", speed);
 }
 
 // Render state
@@ -56,7 +63,7 @@ RenderState sdl_get_render_state(void) {
 }
 
 void sdl_set_render_state(RenderState state) {
-    g_sdl.render_state = state;
+    render_thread_set_int(RENDER_CMD_RENDER_STATE, 0, state);
 }
 
 // Layer accessors
@@ -77,7 +84,7 @@ void sdl_set_layer_alpha(int layer_index, Uint8 alpha) {
     Layer *ly = get_layer_safe(layer_index);
     if (!ly) return;
 
-    ly->alpha = alpha;
+    render_thread_set_int(RENDER_CMD_LAYER_ALPHA, layer_index, alpha);
     g_print("[SDL] Layer %d alpha set to %d\n", layer_index, alpha);
 }
 
@@ -92,7 +99,44 @@ void sdl_set_layer_grayscale(int layer_index, int grayscale) {
     Layer *ly = get_layer_safe(layer_index);
     if (!ly) return;
 
-    ly->grayscale = grayscale ? 1 : 0;
+    render_thread_set_int(RENDER_CMD_LAYER_GRAYSCALE, layer_index, grayscale ? 1 : 0);
+}
+
+// Invert / contrast / threshold (the render thread rebuilds the FX tables)
+gboolean sdl_is_layer_inverted(uint8_t layer_index) {
+    Layer *ly = get_layer_safe(layer_index);
+    if (!ly) return FALSE;
+    return ly->invert ? TRUE : FALSE;
+}
+
+void sdl_set_layer_invert(int layer_index, int invert) {
+    Layer *ly = get_layer_safe(layer_index);
+    if (!ly) return;
+    render_thread_set_int(RENDER_CMD_LAYER_INVERT, layer_index, invert ? 1 : 0);
+}
+
+double sdl_get_layer_contrast(uint8_t layer_index) {
+    Layer *ly = get_layer_safe(layer_index);
+    if (!ly) return 1.0;
+    return ly->contrast;
+}
+
+void sdl_set_layer_contrast(int layer_index, double contrast) {
+    Layer *ly = get_layer_safe(layer_index);
+    if (!ly) return;
+    render_thread_set_double(RENDER_CMD_LAYER_CONTRAST, layer_index, contrast);
+}
+
+int sdl_get_layer_threshold(uint8_t layer_index) {
+    Layer *ly = get_layer_safe(layer_index);
+    if (!ly) return 0;
+    return ly->threshold;
+}
+
+void sdl_set_layer_threshold(int layer_index, int threshold) {
+    Layer *ly = get_layer_safe(layer_index);
+    if (!ly) return;
+    render_thread_set_int(RENDER_CMD_LAYER_THRESHOLD, layer_index, threshold);
 }
 
 // Speed
@@ -107,7 +151,7 @@ void sdl_set_layer_speed(int layer_index, double speed) {
     if (!ly) return;
 
     if (speed <= 0.0) speed = 1.0; // prevent zero or negative speed
-    ly->speed = speed;
+    render_thread_set_double(RENDER_CMD_LAYER_SPEED, layer_index, speed);
     g_print("[SDL] Layer %d speed set to %.2f\n", layer_index, speed);
 }
 
@@ -126,10 +170,13 @@ void sdl_set_layer_modified(int layer_index) {
     Layer *layer = g_sdl.layers[layer_index];
     if (!layer) {
         layer = calloc(1, sizeof(Layer));
+        layer->contrast = 1.0;
+        sdl_update_layer_fx(layer);
         g_sdl.layers[layer_index] = layer;
     }
 
-    layer->state = LAYER_MODIFIED;
+    g_atomic_int_set((gint *)&layer->state, LAYER_MODIFIED);
+    sdl_mark_dirty();
 
     // Set the folder where frames are exported
     char folder[64];
@@ -140,3 +187,26 @@ void sdl_set_layer_modified(int layer_index) {
     g_print("[SDL] Layer %d marked as MODIFIED, folder: %s\n", layer_index, folder);
 }
 
+// Fraction of preloaded frames decoded across loading layers (1.0 = none loading)
+double sdl_get_load_progress(void) {
+    int done = 0, total = 0;
+    for (int i = 0; i < MAX_LAYERS; i++) {
+        Layer *ly = g_sdl.layers[i];
+        if (!ly || !ly->loader) continue;
+        done += frame_loader_get_done(ly->loader);
+        total += frame_loader_get_total(ly->loader);
+    }
+    if (total <= 0) return 1.0;
+    return (double)done / total;
+}
+
+// Frame budget of each streaming layer (applies on next texture update)
+int sdl_get_frame_budget(void) {
+    return g_sdl.frame_budget > 0 ? g_sdl.frame_budget : LAYER_FRAME_BUDGET;
+}
+
+void sdl_set_frame_budget(int frames) {
+    if (frames < 2) frames = 2;   // one on screen, one being decoded
+    g_sdl.frame_budget = frames;
+    g_print("[SDL] Frame budget set to %d frames per layer\n", frames);
+}
@@ -25,6 +25,15 @@ void sdl_set_layer_alpha(int layer_index, Uint8 alpha);
 gboolean sdl_is_layer_gray(uint8_t layer_index);
 void sdl_set_layer_grayscale(int layer_index, int grayscale);
 
+gboolean sdl_is_layer_inverted(uint8_t layer_index);
+void sdl_set_layer_invert(int layer_index, int invert);
+
+double sdl_get_layer_contrast(uint8_t layer_index);
+void sdl_set_layer_contrast(int layer_index, double contrast);
+
+int sdl_get_layer_threshold(uint8_t layer_index);
+void sdl_set_layer_threshold(int layer_index, int threshold);
+
 double sdl_get_layer_speed(uint8_t layer_index);
 void sdl_set_layer_speed(int layer_index, double speed);
 
@@ -33,5 +42,12 @@ void sdl_set_layer_modified(int layer_index);
 
 void sdl_set_layer_state(guint8 layer_index, LayerState new_state);
 
+// --- Loading ---
+double sdl_get_load_progress(void);
+
+// --- Streaming ---
+int sdl_get_frame_budget(void);
+void sdl_set_frame_budget(int frames);
+
 #endif // ACCESSOR_H
 
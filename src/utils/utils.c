@@ -1,6 +1,9 @@
 #include "utils.h"              
 #include "../sdl/sdl.h"       
 #include "accessor.h"
+#include "../media/media_info.h"
+#include "../media/frame_pack.h"
+#include "../media/frame_sink.h"
 
 #include <gtk/gtk.h>
 #include <glib.h>
@@ -185,6 +188,38 @@ int encode_sequence_with_ffmpeg(int sequence_number, int fps, int width, int hei
     gchar *frames_dir = g_build_filename(seq_dir, "mixed_frames", NULL);
     gchar *output_mp4 = g_strdup_printf("%s/sequence_%d.mp4", seq_dir, sequence_number);
 
+    // Baked packs are streamed into the encoder as they decode
+    gchar *pack_path = g_build_filename(seq_dir, FRAME_PACK_NAME, NULL);
+    FramePack *pack = frame_pack_open(pack_path);
+    g_free(pack_path);
+    if (pack) {
+        int src_w, src_h;
+        frame_pack_get_size(pack, &src_w, &src_h);
+        FrameSink *sink = frame_sink_ffmpeg_new(output_mp4, src_w, src_h, fps, width, height);
+
+        int count = frame_pack_get_frame_count(pack);
+        for (int f = 0; sink && f < count; f++) {
+            SDL_Surface *surf = frame_pack_read_frame(pack, f);
+            if (!surf) continue;
+            if (frame_sink_put(sink, f, surf) != 0) {
+                frame_sink_abort(sink);
+                sink = NULL;
+            }
+            SDL_FreeSurface(surf);
+        }
+        frame_pack_close(pack);
+
+        if (!sink || frame_sink_finish(sink) != 0) {
+            add_main_log(g_strdup_printf("[FFMPEG] Encoding failed: %s", output_mp4));
+            goto fail;
+        }
+        add_main_log("[FFMPEG] Video generated successfully.");
+        g_free(seq_dir);
+        g_free(frames_dir);
+        g_free(output_mp4);
+        return 0;
+    }
+
     if (!g_file_test(frames_dir, G_FILE_TEST_IS_DIR)) {
         add_main_log(g_strdup_printf("[FFMPEG] mixed_frames folder not found: %s", frames_dir));
         goto fail;
@@ -233,97 +268,36 @@ void on_modal_back_clicked(GtkButton *button, gpointer user_data) {
     }
 }
 
-// File info utilities
+// File info utilities (read from the media probe cache)
 guint get_duration_in_seconds(const gchar *file_path) {
     if (!file_path || !*file_path) return 0;
 
-    char cmd[1024];
-    snprintf(cmd, sizeof(cmd),
-        "ffprobe -v error -show_entries format=duration "
-        "-of default=noprint_wrappers=1:nokey=1 \"%s\"", file_path
-    );
-
-    FILE *pipe = popen(cmd, "r");
-    if (!pipe) return 0;
-
-    char buf[128] = {0};
-    if (!fgets(buf, sizeof(buf), pipe)) { pclose(pipe); return 0; }
-    pclose(pipe);
-
-    double seconds = g_ascii_strtod(buf, NULL);
-    return (guint)(seconds + 0.5);
+    MediaInfo info;
+    if (!media_info_get(file_path, &info)) return 0;
+    return (guint)(info.duration + 0.5);
 }
 
 gchar* get_resolution(const gchar *file_path) {
-    gchar cmd[512];
-    snprintf(cmd, sizeof(cmd),
-        "ffprobe -v error -select_streams v:0 -show_entries stream=width,height "
-        "-of csv=p=0 \"%s\"", file_path
-    );
-
-    FILE *pipe = popen(cmd, "r");
-    if (!pipe) return g_strdup("--x--");
-
-    char buffer[64];
-    if (fgets(buffer, sizeof(buffer), pipe)) {
-        buffer[strcspn(buffer, "\n")] = 0;
-        pclose(pipe);
-        return g_strdup(buffer);
-    }
-
-    pclose(pipe);
-    return g_strdup("--x--");
+    MediaInfo info;
+    if (!media_info_get(file_path, &info) || info.width <= 0) return g_strdup("--x--");
+    return g_strdup_printf("%dx%d", info.width, info.height);
 }
 
 gchar* get_fps(const gchar *file_path) {
-    gchar cmd[512];
-    snprintf(cmd, sizeof(cmd),
-        "ffprobe -v 0 -of csv=p=0 -select_streams v:0 -show_entries stream=r_frame_rate \"%s\"", file_path
-    );
-
-    FILE *pipe = popen(cmd, "r");
-    if (!pipe) return g_strdup("--");
-
-    char buffer[32];
-    if (fgets(buffer, sizeof(buffer), pipe)) {
-        buffer[strcspn(buffer, "\n")] = 0;
-
-        int num, den;
-        if (sscanf(buffer, "%d/%d", &num, &den) == 2 && den != 0) {
-            pclose(pipe);
-            return g_strdup_printf("%d", num / den);
-        }
-
-        pclose(pipe);
-        return g_strdup(buffer);
-    }
-
-    pclose(pipe);
-    return g_strdup("--");
+    MediaInfo info;
+    if (!media_info_get(file_path, &info) || info.fps <= 0) return g_strdup("--");
+    return g_strdup_printf("%d", (int)info.fps);
 }
 
 gchar* get_duration(const gchar *file_path) {
-    gchar cmd[512];
-    snprintf(cmd, sizeof(cmd),
-        "ffprobe -v error -show_entries format=duration "
-        "-of default=noprint_wrappers=1:nokey=1 \"%s\"", file_path
-    );
-
-    FILE *pipe = popen(cmd, "r");
-    if (!pipe) return g_strdup("--:--");
-
-    char buffer[32];
-    if (fgets(buffer, sizeof(buffer), pipe)) {
-        double seconds = atof(buffer);
-        int h = (int)(seconds / 3600);
-        int m = ((int)seconds % 3600) / 60;
-        int s = (int)seconds % 60;
-        pclose(pipe);
-        return g_strdup_printf("%02d:%02d:%02d", h, m, s);
-    }
-
-    pclose(pipe);
-    return g_strdup("--:--");
+    MediaInfo info;
+    if (!media_info_get(file_path, &info)) return g_strdup("--:--");
+
+    double seconds = info.duration;
+    int h = (int)(seconds / 3600);
+    int m = ((int)seconds % 3600) / 60;
+    int s = (int)seconds % 60;
+    return g_strdup_printf("%02d:%02d:%02d", h, m, s);
 }
 
 gchar* get_filesize(const gchar *file_path) {
@@ -24,6 +24,8 @@
 #define SPACING_DEFAULT 16
 #define BUTTON_SPACING 10
 #define MASTER_FPS 30
+#define LAYER_FRAME_BUDGET 90   // decoded frames kept per streaming layer
+#define LAYER_PLAYABLE_FRAMES 8 // decoded frames before a loading layer starts playing
 
 typedef struct {
     char *base_dir;